@@ -5,6 +5,16 @@
 #include "undo.h"
 #include "game_vars.h"
 #include "test.h"
+#include "board.h"
+#include "anytime.h"
+#include "astar.h"
+#include "bidir.h"
+#include "hda.h"
+#include "eight_table.h"
+#include "endgame_table.h"
+#include "macro_table.h"
+#include "profile.h"
+#include "trace.h"
 
 #define MIN(a,b) (((a)<(b))?(a):(b))
 #define MAX(a,b) (((a)>(b))?(a):(b))
@@ -45,6 +55,16 @@ typedef struct GridTransforms {
 
 jmp_buf exitAi; // buffer used for exiting ai when user hits 'c'
 
+// weights options 1 and 6 can search with, 'w' in the menu goes to the next one
+// above 1 the solution is at most that many times optimal, but found much faster
+const double aiWeights[] = {1, 1.5, 2, 3, 5};
+#define AI_WEIGHTS (sizeof(aiWeights) / sizeof(aiWeights[0]))
+int aiWeight = 0;
+
+static inline void weightMsg(char *msg) {
+	sprintf(msg, "w: weight for 1 and 6 (now %g)", aiWeights[aiWeight]);
+}
+
 // clear a splash screen message by index and message content
 static inline void clearMsg(const int y, char *msg) {
 	timeout(MOVE_DELAY_MS);
@@ -58,7 +78,14 @@ static inline void clearMsgs() {
 	clearMsg(1, "0: Just for fun inefficient algorithm");
 	clearMsg(2, "1: A* with linear conflict + manhattan distance as heuristic");
 	clearMsg(3, "2: https://www.aaai.org/Papers/JAIR/Vol22/JAIR-2209.pdf");
-
+	clearMsg(4, "3: Exact lookup table (3x3 only)");
+	clearMsg(5, "4: Bidirectional search (up to 20 cells)");
+	clearMsg(6, "5: Best solution found in 2 seconds");
+	clearMsg(7, "6: A* with walking distance as heuristic");
+	clearMsg(8, "7: A* on every core (up to 32 cells)");
+	char msg[64];
+	weightMsg(msg);
+	clearMsg(9, msg);
 }
 
 // getch() and return either 'c', 'q', or 0 depending on user input
@@ -75,24 +102,20 @@ char statusGetch() {
 		case 'p':
 		case 'P':
 			return 'p';
+		case 't':
+		case 'T':
+			return 't';
 	}
 	return 0;
 }
 
 // int transforms
 void doNothing(GameVars *game, int *y, int *x) {}
-void negTransform(GameVars *game, int *y, int*x) {
-	*y = game->rows - 1 - *y;
-}
 void swapInts(GameVars *game, int *y, int *x) {
 	const int temp = *y;
 	*y = *x;
 	*x = temp;
 }
-void negTransposedTransform(GameVars *game, int *y, int *x) {
-	swapInts(game, y, x);
-	*y = game->rows - 1 - *y;
-}
 
 // the algorithm to solve a row vs a column are the same, just transposed
 // hence, I will implement a function capable of solving a column
@@ -112,20 +135,33 @@ void getTransposedCoord(GameVars *game, int v, Coordinate *coord) {
 	swapInts(game, &(coord->y), &(coord->x));
 }
 
-void getNegCoord(GameVars *game, int v, Coordinate *coord) {
-	getRealCoord(game, v, coord);
-	coord->y = (game->cols - 1) - coord->y;
-}
-
-// void getNegTransposedCoord(GameVars *game, int v, Coordinate *coord) {
-//         getTransposedCoord(game, v, coord);
-//         coord->y = (game->cols - 1) - coord->y;
-// }
-
 int *returnFirst(int *a, int *b){ return a; }
 int *returnSecond(int *a, int *b){ return b; }
 
+// makes a move without drawing anything, for when the ai plays off screen
+void offscreenSwap(GameVars *game, int swapy, int swapx) {
+	OffscreenMoves *offscreen = game->offscreen;
+	const int y = game->y + swapy;
+	const int x = game->x + swapx;
+	if (y < 0 || y >= game->rows || x < 0 || x >= game->cols || offscreen->count == offscreen->capacity) {
+		longjmp(offscreen->abort, 1);
+	}
+	const int v = getV(game, y, x);
+	game->coordinates[v - 1] = game->y * game->cols + game->x;
+	setV(game, game->y, game->x, v);
+	setV(game, y, x, 0);
+	game->y = y;
+	game->x = x;
+	offscreen->moves[offscreen->count++] = swapy ? (swapy < 0 ? 'u' : 'd') : (swapx < 0 ? 'l' : 'r');
+}
+
 void realSwap(GameVars *game, int swapy, int swapx, char direction) {
+	PROFILE_MOVE();
+	if (game->offscreen != NULL) {
+		offscreenSwap(game, swapy, swapx);
+		return;
+	}
+
 	// update coordinate of swapped cell
 	const int v = getV(game, game->y + swapy, game->x + swapx);
 	int newCoordinate = game->coordinates[v - 1];
@@ -144,6 +180,10 @@ void realSwap(GameVars *game, int swapy, int swapx, char direction) {
 			printArr(0, 0, game->coordinates, game->rows * game->cols - 1);
 			quitGetch();
 			mvhline(0, 0, ' ', 255);
+			break;
+		case 't':
+			mvhline(0, 0, ' ', 69);
+			mvprintw(0, 0, dumpTraceFile(TRACE_FILE) ? "wrote the trace to " TRACE_FILE : "couldn't write " TRACE_FILE);
 	}
 }
 
@@ -164,47 +204,6 @@ void transposedSwap(GameVars *game, int swapy, int swapx, char direction) {
 	realSwap(game, swapx, swapy, direction);
 }
 
-void negSwap(GameVars *game, int swapy, int swapx, char direction) {
-	switch (direction) {
-		case 'u':
-			direction = 'd';
-			break;
-		case 'd':
-			direction = 'u';
-	}
-	realSwap(game, -swapy, swapx, direction);
-}
-
-void transposedNegSwap(GameVars *game, int swapy, int swapx, char direction) {
-	/* transposing followed by negating is described by this matrix:
-	 * |0 -1|
-	 * |1  0|
-	 * with vectors being <y, x> 
-	 * aka a 90 degree counterclockwise rotation
-	 * we need to invert this matrix bc we need to convert
-	 * transformed coords to real coords:
-	 * the inverse is a 90 degree clockwise rotation:
-	 * | 0 1|
-	 * |-1 0*/
-	switch (direction) {
-		case 'u':
-			direction = 'l';
-			break;
-		case 'l':
-			direction = 'u';
-			break;
-		case 'd':
-			direction = 'r';
-			break;
-		case 'r':
-			direction = 'd';
-	}
-	const int temp = swapy;
-	swapy = swapx;
-	swapx = -temp;
-	realSwap(game, swapy, swapx, direction);
-}
-
 // assumes starting to the left of the cell
 void upRight(GameVars *game, SwapFunction swap, int n) {
 	while (n-- > 0) {
@@ -326,7 +325,8 @@ void moveUpDown(GameVars *game, SwapFunction swap, int n) {
 // without moving in to *a
 // then move to the left in order to swap places with *a
 void positionFromRight(GameVars *game, Coordinate *a, int doneCol, GridTransforms *funcs) {
-	interactiveDebug("fromRight");
+	PROFILE_PHASE(PHASE_FROM_RIGHT);
+	TRACE(TRACE_INFO, "fromRight");
 	int transx, transy;
 	transy = game->y;
 	transx = game->x;
@@ -381,43 +381,12 @@ void positionFromRight(GameVars *game, Coordinate *a, int doneCol, GridTransform
 	LEFT();
 }
 
-// special case when moving second to last cell
-// in to pre-position
-void positionFromRightSpecial(GameVars *game, Coordinate *a, int doneCol, GridTransforms *funcs) {
-	// special case where second to last cell is 1 to the left of its pre position
-	// this single special case is the only reason this function exists
-	if (a->y == 0 && a->x == doneCol - 1) {
-		int transx, transy;
-		transy = game->y;
-		transx = game->x;
-		funcs->transformInts(game, &transy, &transx);
-		const SwapFunction swap = funcs->swap;
-
-		if (transy == a->y) {
-			if (transx == a->x + 1) {
-				LEFT();
-				return;
-			}
-			DOWN();
-			transy++;
-		}
-		// 0 is below *a
-
-		moveUpFor(game, swap, transy - 1);
-		moveRightFor(game, swap, doneCol - transx);
-		UP();
-		LEFT();
-	}
-	else {
-		positionFromRight(game, a, doneCol, funcs);
-	}
-}
-
 // move 0 directly below *a without moving in to *a
 // and without moving in to previously solved cells (anything below *b)
 // then move up in order to swap places with *a
 void positionFromBottom(GameVars *game, Coordinate *a, GridTransforms *funcs) {
-	interactiveDebug("fromBottom");
+	PROFILE_PHASE(PHASE_FROM_BOTTOM);
+	TRACE(TRACE_INFO, "fromBottom");
 	int transx, transy;
 	transy = game->y;
 	transx = game->x;
@@ -426,17 +395,17 @@ void positionFromBottom(GameVars *game, Coordinate *a, GridTransforms *funcs) {
 
 	if (transx == a->x) {
 		if (transy < a->y) {
-			interactiveDebug("transy < a->y");
+			TRACE(TRACE_DEBUG, "transy < a->y");
 			// 0 is above *a
 			// need to move to move around so we can come in from below
 			if (transx) { // if there is space to the left
-				interactiveDebug("transx");
+				TRACE(TRACE_DEBUG, "transx");
 				LEFT();
 				moveDownFor(game, swap, a->y + 1 - transy);
 				RIGHT();
 			}
 			else {
-				interactiveDebug("!transx");
+				TRACE(TRACE_DEBUG, "!transx");
 				RIGHT();
 				moveDownFor(game, swap, a->y + 1 - transy);
 				LEFT();
@@ -444,7 +413,7 @@ void positionFromBottom(GameVars *game, Coordinate *a, GridTransforms *funcs) {
 			UP();
 		}
 		else {
-			interactiveDebug("transy >= a->y");
+			TRACE(TRACE_DEBUG, "transy >= a->y");
 			// 0 is below *a
 			// move up until we swap with it
 			moveUpFor(game, swap, transy - a->y);
@@ -472,7 +441,8 @@ void positionFromBottom(GameVars *game, Coordinate *a, GridTransforms *funcs) {
 // and without moving in to previously solved cells (anything below *b)
 // then move down in order to swap places with *a
 void positionFromTop(GameVars *game, Coordinate *a, GridTransforms *funcs) {
-	interactiveDebug("fromTop");
+	PROFILE_PHASE(PHASE_FROM_TOP);
+	TRACE(TRACE_INFO, "fromTop");
 	int transx, transy;
 	transy = game->y;
 	transx = game->x;
@@ -480,10 +450,10 @@ void positionFromTop(GameVars *game, Coordinate *a, GridTransforms *funcs) {
 	const SwapFunction swap = funcs->swap;
 	
 	if (transx == a->x) {
-		interactiveDebug("transx == a->x: %i", transx == a->x);
+		TRACE(TRACE_DEBUG, "transx == a->x: %i", transx == a->x);
 		// 0 is in same column as *a
 		if (transy < a->y) {
-			interactiveDebug("transy < a->y: %i", transy < a->y);
+			TRACE(TRACE_DEBUG, "transy < a->y: %i", transy < a->y);
 			// 0 is in same column and above *a
 			// just need to move down past *a
 			moveDownFor(game, swap, a->y - transy);
@@ -503,7 +473,7 @@ void positionFromTop(GameVars *game, Coordinate *a, GridTransforms *funcs) {
 			}
 			DOWN();
 		}
-		interactiveDebug("returning");
+		TRACE(TRACE_DEBUG, "returning");
 		return;
 	}
 	
@@ -527,6 +497,7 @@ void positionFromTop(GameVars *game, Coordinate *a, GridTransforms *funcs) {
 // 	2. move A diagonally until it's either in the same row or column as B
 // 	3. Move A in a horizontal/vertical line to B if neccesary
 void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTransforms *funcs) {
+	PROFILE_PHASE(PHASE_MOVE_A_TO_B);
 	const int vertDist = b->y - a->y;
 	const int horDist = b->x - a->x;
 	if (!vertDist && !horDist) {
@@ -537,12 +508,12 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 	int transy = game->y;
 	funcs->transformInts(game, &transy, &transx);
 	const SwapFunction swap = funcs->swap;
-	interactiveDebug("vertDist: %i", vertDist);
+	TRACE(TRACE_DEBUG, "vertDist: %i", vertDist);
 	if (vertDist >= 0) { // a* is aboveor level with  b*
 		if (horDist > vertDist) { // more distance horizontally than vertically
 			positionFromRight(game, a, doneCol, funcs);
 			if (vertDist) {
-				interactiveDebug("down right up");
+				TRACE(TRACE_DEBUG, "down right up");
 				DOWN();
 				RIGHT();
 				UP();
@@ -558,7 +529,7 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 			// because vertical distance changed by 1 in positionFromBottom
 			downRight(game, swap, 2 * horDist);
 			
-			// interactiveDebug("vertDist - horDist: %i", vertDist - horDist);
+			// TRACE(TRACE_DEBUG, "vertDist - horDist: %i", vertDist - horDist);
 			shiftDown(game, swap, vertDist  - 1 - horDist);
 		}
 
@@ -584,13 +555,13 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 		// if 0 in top right quadrant positionFromRight
 		// otherwise positionFromBottom because it is either correct or irrelevant
 		else if ((a->x <= transx) && (a->y >= transy)) {
-			// interactiveDebug("a->x <= game->x: %i, a->y >= game->y: %i", a->x <= game->x, a->y >= game->y)
+			// TRACE(TRACE_DEBUG, "a->x <= game->x: %i, a->y >= game->y: %i", a->x <= game->x, a->y >= game->y)
 			positionFromRight(game, a, doneCol, funcs);
-			interactiveDebug("down right up");
+			TRACE(TRACE_DEBUG, "down right up");
 			DOWN();
 			RIGHT();
 			UP();
-			interactiveDebug("2 * (vertDist - 1): %i", 2 * (vertDist - 1));
+			TRACE(TRACE_DEBUG, "2 * (vertDist - 1): %i", 2 * (vertDist - 1));
 			downRight(game, swap, 2 * (horDist - 1));
 		}
 		else {
@@ -603,19 +574,16 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 		// this is a pain because we aren't allowed to enter any cells below B
 		// because they're already been set correctly
 		// an important value is int vertness = a->y - b->y - (b->x - a->x)
-		// there are 3 scenarios:
-		// 1. vertness >= 1
+		// there are 2 scenarios:
+		// 1. vertness >= 0
 		//	- positioning from the top is at minimum as efficient as from the right
 		//	- if (horzDist > 1)
 		//	  	1. right, up, left
 		//	  	2. 2 * (horDist) - 3 cycles
-		// 	- shift up a->y - b->y - 1 times
+		//	- that leaves *a just left of b's column, vertness below b
+		// 	- shift up vertness times
 		// 	- 360
-		// 2. vertness == 0
-		//	- positioning from the top is at minimum as efficient as from the right
-		//	- do 2 * (a->x - b->x - 1) cycles
-		//	- 360
-		// 3. vertness <= -1
+		// 2. vertness <= -1
 		// 	- position from right
 		// 	- (-2) * vertDistance - 1 cycles
 		// 	- get to right of cell
@@ -624,8 +592,8 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 		// 	- (-1 - vertness) right shifts
 
 		const int vertness = a->y - b->y - (b->x - a->x);
-		interactiveDebug("vertness: %i", vertness);
-		if (vertness >= 1) {
+		TRACE(TRACE_DEBUG, "vertness: %i", vertness);
+		if (vertness >= 0) {
 			positionFromTop(game, a, funcs);
 			if (horDist > 1) {
 				RIGHT();
@@ -633,30 +601,18 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 				LEFT();
 				upRight(game, swap, 2 * horDist - 3);
 			}
-			else if (vertDist > 1) {
-				shiftUp(game, swap, -vertDist - horDist);
-				DO360();
-			}
-		}
-		else if (vertness == 0) {
-			positionFromTop(game, a, funcs);
-			upRight(game, swap, 2 * (a->x - b->x - 1));
+			shiftUp(game, swap, vertness);
 			DO360();
 		}
 		else {
 			positionFromRight(game, a, doneCol, funcs);
-			interactiveDebug("wtf-2 * vertDist - 1: %i", -2 * vertDist - 1);
+			TRACE(TRACE_DEBUG, "wtf-2 * vertDist - 1: %i", -2 * vertDist - 1);
 			upRight(game, swap, -2 * vertDist - 1);
 			
-			// when vertness < 0, the length of the box with corners *a and *b
-			// is greater than the height of the box
-			// the box also has a minimum height of 2
-			// therefore the smallest box for scenario vertness < 0 is a 2 x 3 (width 2)
-			// this is the only case where a 360 is neccesary to not mess up
-			// solved cells. therefore check if horDist == 2 to see if we need
-			// to 360
-			const int minWidth = 2;
-			if (horDist == minWidth) {
+			// the cycles leave *a -vertness to the left of *b with 0 under it
+			// if that's right next to *b, going right would move the solved cell under *b
+			// so 360 instead
+			if (vertness == -1) {
 				DO360();
 			}
 			else {
@@ -669,152 +625,159 @@ void moveAToB(GameVars *game, Coordinate *a, Coordinate *b, int doneCol, GridTra
 	}
 }
 
+// performs a single move given as one of "urdl"
+void doMove(GameVars *game, SwapFunction swap, char move) {
+	switch (move) {
+		case 'l':
+			LEFT();
+			break;
+		case 'd':
+			DOWN();
+			break;
+		case 'u':
+			UP();
+			break;
+		case 'r':
+			RIGHT();
+	}
+}
+
 // performs a series of moves
 void doMoves(GameVars *game, SwapFunction swap, char *moves) {
-	do {
-		switch (*moves) {
-			case 'l':
-				LEFT();
-				break;
-			case 'd':
-				DOWN();
-				break;
-			case 'u':
-				UP();
-				break;
-			case 'r':
-				RIGHT();
-		}
-		moves++;
-	} while (*moves);
+	for (; *moves; moves++) {
+		doMove(game, swap, *moves);
+	}
 }
 
-bool secondLastToPrePos(GameVars *game, Coordinate *secondLast, Coordinate *last, int transcol, GridTransforms *funcs) {
-	int horDist = transcol - secondLast->x;
-	int vertness = secondLast->y - horDist;
+// moves *a on to *b with the optimal moves from macro_table.h
+// only possible when *a and 0 are both in the window around *b gen_macros.c searched
+// returns whether it moved *a
+bool macroAToB(GameVars *game, Coordinate *a, Coordinate *b, int regionHeight, GridTransforms *funcs) {
+	PROFILE_PHASE(PHASE_MACRO);
+	const int left = MIN(b->x, MACRO_MAX_LEFT);
+	const int up = MIN(b->y, MACRO_MAX_UP);
+	const int down = b->y + 1 < regionHeight;
+
+	int transx = game->x;
+	int transy = game->y;
+	funcs->transformInts(game, &transy, &transx);
+
+	// coordinates relative to the top left of the window
+	const int ay = a->y - (b->y - up);
+	const int ax = a->x - (b->x - left);
+	const int zeroy = transy - (b->y - up);
+	const int zerox = transx - (b->x - left);
+	const bool aInside = ay >= 0 && ay <= up + down && ax >= 0 && ax <= left;
+	const bool zeroInside = zeroy >= 0 && zeroy <= up + down && zerox >= 0 && zerox <= left;
+	if (!aInside || !zeroInside) {
+		return false;
+	}
+
+	char *moves = macroMoves[left - 2][up - 2][down][ay * MACRO_WIDTH + ax][zeroy * MACRO_WIDTH + zerox];
+	if (moves == NULL) { // one of them is on the solved cell below *b
+		return false;
+	}
 	const SwapFunction swap = funcs->swap;
-	// vertness >= 0:
-	//	* positionFromTop
-	//	* 2 * (b->x - a->x) cycle
-	// 	* vertness upshifts
-	// 	* RIGHT(); UP(); LEFT();
-	// else:
-	// 	* positionFromRight
-	// 	* 2 * (a->y - b->y) cycles
-	// 	* -vertness - 1 rightshifts
+	DOMOVES(moves);
+	return true;
+}
+
+// moves the tile at *a on to *b, or just 0 on to *b if a is NULL, in as few moves as it can
+// without moving any cell in locked
+// searches over where the tile and 0 are in the height x width area in the top left
+// (in transformed coordinates), which is never more than MAX_CELLS^2 states
+// returns whether it was possible
+bool searchAToB(GameVars *game, Coordinate *a, Coordinate *b, int height, int width, const bool *locked, GridTransforms *funcs) {
+	const int n = height * width;
 	int transx = game->x;
 	int transy = game->y;
 	funcs->transformInts(game, &transy, &transx);
-	if (vertness > 0) {
-		const bool secondLastInOneZero = secondLast->y == 1 && horDist == 1;
-		const bool zeroInOneOne = transy == 1 && transx == transcol;
-		if (secondLastInOneZero && zeroInOneOne) {
-			/* special case:
-			 * XA
-			 * B0
-			 * X can be anything, A is goal position, B is initial position, 0 is 0
-			 * In this case do LEFT(); UP(); RIGHT(); DOWN();
-			 */
-			LEFT();
-			UP();
-			RIGHT();
-			DOWN();
+	if (transy >= height || transx >= width || (a != NULL && (a->y >= height || a->x >= width))) {
+		return false;
+	}
+	const int start = (a == NULL ? n : a->y * width + a->x) * n + transy * width + transx;
+	const int target = b->y * width + b->x;
+
+	// states are tile * n + 0, with tile n when there's no tile
+	const int states = (n + 1) * n;
+	int *parents = malloc(states * sizeof(int));
+	int *queue = malloc(states * sizeof(int));
+	char *moves = malloc(states);
+	for (int i = 0; i < states; i++) {
+		parents[i] = -1;
+	}
+	parents[start] = start;
+	queue[0] = start;
+	int found = -1;
+	for (int head = 0, tail = 1; head < tail && found < 0; head++) {
+		const int state = queue[head];
+		const int tile = state / n;
+		const int blank = state % n;
+		if ((a == NULL ? blank : tile) == target) {
+			found = state;
+			break;
 		}
-		else {
-			positionFromTop(game, secondLast, funcs);
-			if (horDist) {
-				if (horDist > 1) {
-					RIGHT();
-					UP();
-					LEFT();
-				}
-				upRight(game, swap, 2 * (horDist - 1) - 1);
-				shiftUp(game, swap, secondLast->y - horDist);
-				RIGHT();
-				UP();
-				LEFT();
+		const int y = blank / width;
+		const int x = blank % width;
+		for (int move = 0; move < 4; move++) {
+			int to;
+			switch (move) {
+				case MOVE_UP:
+					to = y ? blank - width : -1;
+					break;
+				case MOVE_DOWN:
+					to = y < height - 1 ? blank + width : -1;
+					break;
+				case MOVE_RIGHT:
+					to = x < width - 1 ? blank + 1 : -1;
+					break;
+				default:
+					to = x ? blank - 1 : -1;
 			}
-		}
-	}
-	else {
-		// special case
-		// if last is in its correct position and secondLast is not
-		// when we try to move in secondLast we will get last stuck
-		const int diagCycles = 2 * secondLast->y;
-		const bool wouldStuck = last->y == 0 && last->x == transcol;
-		if (wouldStuck) {
-			// special cases: vertness == 0 and vertness == -1
-			if (vertness > -2) {
-				// special case: 3x3 and 0 is in right mid
-				// is shorter than what we'd do otherwise
-				if (vertness == 0 && horDist == 2 && transy == 1 && transx == transcol) {
-					DOMOVES("ullddrulurrdl");
-					return true;
-				}
-				else if (vertness == 0) {
-					// look at the last 2 grids in effics.txt
-					// look at the relationships of the move distances
-					// and compare them between the 2 grids; notice the similarity?
-					// (1, 3) is the same as (1, 5) when you move 0 down in to b
-					positionFromTop(game, secondLast, funcs);
-					transy = secondLast->y;
-					transx = secondLast->x;
-					secondLast->y--;
-				}
-				
-				if (horDist > 2) {
-					positionFromRight(game, secondLast, transcol, funcs);
-					upRight(game, swap, 2 * (horDist - 2) - 1);
-					RIGHT();
-					UP();
-				}
-				else {
-					moveRightFor(game, swap, transcol - 1 - transx);
-					moveUpFor(game, swap, transy - 1);
-				}
-				DOMOVES("ruldlurrdl");
+			if (to < 0 || locked[to]) {
+				continue;
 			}
-			else {
-				positionFromRight(game, secondLast, transcol, funcs);
-				upRight(game, swap, diagCycles - 1);
-
-				interactiveDebug("wouldStuck vertness < -1");
-				// if we get any close than 2 without
-				// preparation we'll get stuck so - 2
-				// (horDist - 1) bc positionFromRight
-				// moved it over 1
-				const int shiftDist = (horDist - 1) - 2; 
-				interactiveDebug("shiftright %i times", shiftDist);
-				// shiftRightD
-				// shift right, moving down to go around
-				for (int i = 0; i < shiftDist; i++) {
-					RIGHT();
-					UP();
-					LEFT();
-					DOWN();
-					RIGHT();
-					RIGHT();
-				}
-
-				interactiveDebug("choreographed rrulldrrul");
-				DOMOVES("rrulldrrul");
+			const int next = (to == tile ? blank : tile) * n + to;
+			if (parents[next] < 0) {
+				parents[next] = state;
+				moves[next] = moveChars[move];
+				queue[tail++] = next;
 			}
-			return true;
-		}
-		else if (vertness == 0) {
-			positionFromTop(game, secondLast, funcs);
-			RIGHT();
-			UP();
-			LEFT();
-			upRight(game, swap, 2 * (horDist - 1));
-		}
-		else {
-			positionFromRightSpecial(game, secondLast, transcol, funcs);
-			upRight(game, swap, diagCycles);
-			shiftRightD(game, swap, horDist - 1 - secondLast->y);
 		}
 	}
-	return false;
+
+	// the moves come out backwards. they're copied off the heap before any are made,
+	// since a move can longjmp out of here
+	int length = 0;
+	for (int state = found; found >= 0 && state != start; state = parents[state]) {
+		length++;
+	}
+	char path[length + 1];
+	for (int i = 0, state = found; i < length; i++, state = parents[state]) {
+		path[i] = moves[state];
+	}
+	free(parents);
+	free(queue);
+	free(moves);
+	const SwapFunction swap = funcs->swap;
+	while (length--) {
+		doMove(game, swap, path[length]);
+	}
+	return found >= 0;
+}
+
+// puts secondLast in the top of the column, where last goes, so that last can go next to it
+// the column below them is solved, and stays that way
+bool secondLastToPrePos(GameVars *game, Coordinate *secondLast, int regionHeight, int transcol, bool *locked,
+		GridTransforms *funcs) {
+	PROFILE_PHASE(PHASE_SECOND_LAST);
+	Coordinate corner = {0, transcol};
+	return searchAToB(game, secondLast, &corner, regionHeight, transcol + 1, locked, funcs);
+}
+
+// whether *a is in the 2x2 at the top of the column
+static inline bool insideCorner(Coordinate *a, int transcol) {
+	return a->y < 2 && (a->x == transcol - 1 || a->x == transcol);
 }
 
 // solve a column/tranposed column of the grid
@@ -824,26 +787,31 @@ void funAiColumn(GameVars *game, GridTransforms *funcs, int row, int col) {
 	// solve up to the top 2 cells in the column
 	int *cellRow = funcs->returnNth(&row, &col);
 	const int transcol = *funcs->returnNth(&col, &row);
+	const int regionHeight = *cellRow + 1; // number of unsolved rows (transformed)
 	
 	for (; *cellRow > 1; (*cellRow)--) {
-		interactiveDebug("new cellRow");
+		TRACE(TRACE_INFO, "new cellRow");
 		Coordinate a;
 		funcs->getCoord(game, row * game->cols + col, &a);
-		interactiveDebug("(a->y, a->x): (%i, %i)", a.y, a.x);
+		TRACE(TRACE_DEBUG, "(a->y, a->x): (%i, %i)", a.y, a.x);
 		Coordinate b = {row, col};
 		funcs->transformInts(game, &b.y, &b.x);
-		interactiveDebug("(b->y, b->x): (%i, %i)", b.y, b.x);
-		moveAToB(game, &a, &b, transcol, funcs);
+		TRACE(TRACE_DEBUG, "(b->y, b->x): (%i, %i)", b.y, b.x);
+		if (!macroAToB(game, &a, &b, regionHeight, funcs)) {
+			moveAToB(game, &a, &b, transcol, funcs);
+		}
 		mvhline(1, 0, ' ', 255);
 	} 
 
 	// solve the last 2 cells in the column
 	// check if last 2 cells are already in position
 	Coordinate secondLast, last;
-	funcs->getCoord(game, game->cols * row + col, &secondLast);
-	interactiveDebug("secondLast.y, secondLast.x: %i, %i", secondLast.y, secondLast.x);
+	const int secondLastValue = game->cols * row + col;
+	funcs->getCoord(game, secondLastValue, &secondLast);
+	TRACE(TRACE_DEBUG, "secondLast.y, secondLast.x: %i, %i", secondLast.y, secondLast.x);
 	(*cellRow)--;
-	funcs->getCoord(game, game->cols * row + col, &last);
+	const int lastValue = game->cols * row + col;
+	funcs->getCoord(game, lastValue, &last);
 
 	const bool lastCorrect = !last.y && (last.x == transcol);
 	const bool secondLastCorrect = (secondLast.y == 1) && (secondLast.x == transcol);
@@ -851,214 +819,93 @@ void funAiColumn(GameVars *game, GridTransforms *funcs, int row, int col) {
 		return;
 	}
 		
-	// there are a bunch of special cases when the last 2 cells are not in position
-	// but are in the top right 2x2
-	int transx = game->x;
-	int transy = game->y;
-	funcs->transformInts(game, &transy, &transx);
-	const SwapFunction swap = funcs->swap;
-
-	const bool lastInside = (last.y < 2) && (last.x >= transcol - 1);
-	const bool secondLastInside = (secondLast.y < 2) && (secondLast.x >= transcol - 1);
-	if (lastInside && secondLastInside) {
-		// both are inside the 2x2 but not in position
-		// I brute forced all special cases (effic.py)
-		// will now handle each special case with those results
-
-		// convert coordinates to indices in 2x2
-		// 0 = top left,    1 = top right,
-		// 2 = bottom left, 3 = bottom right
-		last.x -= transcol - 1;
-		const int lastIndex = 2 * last.y + last.x;
-		secondLast.x -= transcol - 1;
-		const int secondLastIndex = 2 * secondLast.y + secondLast.x;
-
-		if (lastIndex == 0 && secondLastIndex == 1) {
-			// get 0 to 2nd row
-			moveDownFor(game, swap, transy - 1);
-			moveUpFor(game, swap, 1 - transy);
-			// rightmost cell
-			moveRightFor(game, swap, transcol - 1);
-			// finish
-			UP();
-			LEFT();
-		}
-		else if (lastIndex == 0 && secondLastIndex == 2) {
-			if (transx == transcol) {
-				DOMOVES("llurrdluldrrul");
-			}
-			else {
-				// get 0 to the correct column
-				moveRightLeft(game, swap, (transcol - 2) - transx);
-				// get 0 within the first 2 rows
-				moveUpFor(game, swap, transy - 1);
-				if (transy == 0) {
-					DOMOVES("rdrulldrrul");
-				}
-				else {
-					DOMOVES("rurdllurrdl");
-				}
-			}
-		}
-		else if (lastIndex == 0 && secondLastIndex == 3) {
-			moveRightLeft(game, swap, transcol - 2 - transx);
-			moveUpFor(game, swap, transy);
-			DOMOVES("rrdluldrrul");
-		}
-		else if (lastIndex == 1 && secondLastIndex == 0) {
-			moveRightLeft(game, swap, transcol - 2 - transx);
-			moveUpFor(game, swap, transy);
-			DOMOVES("rdrulldrurdl");
-		}
-		else if (lastIndex == 1 && secondLastIndex == 2) {
-			if (transx == transcol) {
-				LEFT();
-			}
-			else {
-				moveRightLeft(game, swap, transcol - 2 - transx);
-				moveUpDown(game, swap, transy - 1);
-				DOMOVES("rruldlurrdl");
-			}
-		}
-		else if (lastIndex == 2 && secondLastIndex == 0) {
-			if (transx == transcol) {
-				DOMOVES("lurdl");
-			}
-			else {
-				moveRightLeft(game, swap, transcol - 2 - transx);
-				moveUpFor(game, swap, transy - 1);
-				if (transy == 0) {
-					DOMOVES("rrdluldrurdl");
-				}
-				else {
-					DOMOVES("rruldlurdrul");
-				}
-			}
-		}
-		else if (lastIndex == 2 && secondLastIndex == 1) {
-			if (transx == transcol) {
-				DOMOVES("ulldrurdllurdrul");
-			}
-			else {
-				if (!(transy == 0 && transx == transcol - 1)) {
-					moveRightLeft(game, swap, transcol - 2 - transx);
-					moveUpFor(game, swap, transy);
-					RIGHT();
-				}
-				DOMOVES("drul");
-			}
+	// the last 2 cells are not both in position
+	// put secondLast where last goes, then last next to it, then get 0 under secondLast
+	// and rotate them in to place
+	// if last ends up stuck under secondLast, or they're both in the 2x2 to start with,
+	// look the moves up in the endgame table instead
+	if (!insideCorner(&last, transcol) || !insideCorner(&secondLast, transcol)) {
+		const int width = transcol + 1;
+		bool locked[regionHeight * width];
+		for (int i = 0; i < regionHeight * width; i++) {
+			locked[i] = i % width == transcol && i / width > 1;
 		}
-		else if (lastIndex == 2 && secondLastIndex == 3) {
-			moveRightLeft(game, swap, transcol - 2 - transx);
-			moveUpDown(game, swap, transy);
-			DOMOVES("rurdllurdrul");
-		}
-		else if (lastIndex == 3 && secondLastIndex == 0) {
-			moveUpDown(game, swap, transy - 1);
-			moveRightFor(game, swap, transcol - 1 - transx);
-			DOMOVES("urdl");
-		}
-		else if (lastIndex == 3 && secondLastIndex == 1) {
-			moveRightFor(game, swap, transcol - 1 - transx);
-			moveUpFor(game, swap, transy - 1);
-			if (transy == 0) {
-				DOMOVES("rdllurdrulldrurdl");
-			}
-			else {
-				DOMOVES("rulldrurdllurdrul");
-			}
+		if (!secondLastToPrePos(game, &secondLast, regionHeight, transcol, locked, funcs)) {
+			TRACE(TRACE_WARN, "couldn't get %i to the top of column %i", secondLastValue, transcol);
+			return;
 		}
-		else { // lastIndex == 3 && secondLastIndex == 2
-			if (transy) {
-				moveRightLeft(game, swap, transcol - 2 - transx);
-				moveUpFor(game, swap, transy);
-				moveRightFor(game, swap, 2);
-			}
-			else {
-				moveRightFor(game, swap, transcol - transx);
+		funcs->getCoord(game, secondLastValue, &secondLast);
+		funcs->getCoord(game, lastValue, &last);
+		if (!insideCorner(&last, transcol)) {
+			PROFILE_PHASE(PHASE_FINAL_ROTATION);
+			TRACE(TRACE_INFO, "final rotation");
+			locked[transcol] = true;
+			Coordinate beside = {0, transcol - 1};
+			Coordinate under = {1, transcol};
+			if (!searchAToB(game, &last, &beside, regionHeight, width, locked, funcs)) {
+				TRACE(TRACE_WARN, "couldn't get %i next to the top of column %i", lastValue, transcol);
+				return;
 			}
-			DOWN();
+			locked[transcol - 1] = true;
+			searchAToB(game, NULL, &under, regionHeight, width, locked, funcs);
+			const SwapFunction swap = funcs->swap;
+			UP();
 			LEFT();
-		} 
-		return;
-	}
-
-	// not both are inside the 2x2
-	// we can move them normally
-	const bool needMoveSecondLast = !(secondLast.x == transcol && secondLast.y == 0);
-	if (needMoveSecondLast && secondLastToPrePos(game, &secondLast, &last, transcol, funcs)) {
-		return;
-	}
-	funcs->getCoord(game, game->cols * row + col, &last);
-	IntsTransform originalTransform = funcs->transformInts;
-	if (!(last.x == transcol - 1 && last.y == 0)) {
-		// moving last to its preposition is not a special case
-		// if we turn the board upside down
-
-		// set the grid transform functions
-		// returnNth and getCoord are irrelevant
-		if (funcs->transformInts == &doNothing) {
-			interactiveDebug("normal board");
-			funcs->transformInts = &negTransform;
-			funcs->swap = &negSwap;
-		}
-		else {
-			interactiveDebug("transposed board");
-			// notice that transform is negTranposed but swap is transposedNeg
-			// this is because T(N(<y, x>)) does not equal N(T(<y, x>)) in general
-			// transform is NT because transform is meant to be used on real coordinates
-			// and therefore we want to replicate the actual transformation
-			// swap is TN because swap is done in transformed coordinates;
-			// we need to work backwards to get to real coordinates
-			funcs->transformInts = &negTransposedTransform;
-			funcs->swap = &transposedNegSwap;
+			return;
 		}
-		Coordinate finalPos = {row, col};
-		funcs->transformInts(game, &finalPos.y, &finalPos.x);
-		finalPos.x--;
-		funcs->getCoord(game, row * game->cols + col, &last);
-		negTransform(game, &last.y, &last.x);
-		interactiveDebug("*cellRow: %i, transcol: %i, finalPos.y: %i, finalPos.x: %i", *cellRow, transcol, finalPos.y, finalPos.x);
-		interactiveDebug("moving (transformed) (%i, %i) to (%i, %i)", last.y, last.x, finalPos.y, finalPos.x);
-		moveAToB(game, &last, &finalPos, transcol, funcs);
 	}
 
-	// both in pre-position; make the final rotation
-	interactiveDebug("final rotation");
-	transy = game->y;
-	transx = game->x;
-	originalTransform(game, &transy, &transx);
-	interactiveDebug("transy: %i, transx: %i", transy, transx);
-	if (!transy) {
-		interactiveDebug("transy = %i > 0 so DOWN();RIGHT();", transy)
-		DOWN();
-		RIGHT();
+	// both are inside the 2x2 but not in position
+	// gen_endgame.c brute forces every layout of these 2 cells and 0
+	// in the 3x3 window in the top right of the unsolved area
+	// so get 0 in to the window and look up the moves
+	PROFILE_PHASE(PHASE_PAIR_ENDGAME);
+	int transx = game->x;
+	int transy = game->y;
+	funcs->transformInts(game, &transy, &transx);
+	const SwapFunction swap = funcs->swap;
+	moveRightFor(game, swap, (transcol - 2) - transx);
+	const int height = MIN(regionHeight, 3);
+	moveUpFor(game, swap, transy - (height - 1));
+	transx = MAX(transx, transcol - 2);
+	transy = MIN(transy, height - 1);
+
+	// convert coordinates to indices in the window
+	const int windowLeft = transcol - 2;
+	const int lastIndex = 3 * last.y + last.x - windowLeft;
+	const int secondLastIndex = 3 * secondLast.y + secondLast.x - windowLeft;
+	const int zeroIndex = 3 * transy + transx - windowLeft;
+	char *moves = endgameMoves[height - 2][lastIndex][secondLastIndex][zeroIndex];
+	if (moves != NULL) { // only NULL if an earlier step left 0 outside the unsolved area
+		DOMOVES(moves);
 	}
-	RIGHT();
-	UP();
-	LEFT();
 }
 
-void funAi(GameVars *game) {
-	// make array of cell coordinates
+// fill game->coordinates with the index of every cell but 0
+void fillCoordinates(GameVars *game) {
 	const int length = game->rows * game->cols - 1;
-	int coordinates[length];
-	game->coordinates = coordinates;
 	int i = 0;
 	for (const int zeroCoord = game->y * game->cols + game->x; i < zeroCoord; i++) {
 		const int cell = getV(game, i / game->cols, i % game->cols);
 		game->coordinates[cell - 1] = i;
-		// interactiveDebug("%i", cell);
+		// TRACE(TRACE_DEBUG, "%i", cell);
 	}
 	i++; // skip over 0
 	for (; i < length + 1; i++) {
 		const int cell = getV(game, i / game->cols, i % game->cols);
 		game->coordinates[cell - 1] = i;
-		// interactiveDebug("%i", cell);
+		// TRACE(TRACE_DEBUG, "%i", cell);
 	}
+}
+
+void funAi(GameVars *game) {
+	// make array of cell coordinates
+	int coordinates[game->rows * game->cols - 1];
+	game->coordinates = coordinates;
+	fillCoordinates(game);
 
 	// make it so there are as many unsolved rows as unsolved columns
-	i = game->cols - game->rows;
+	int i = game->cols - game->rows;
 	if (i > 0) { // if more columns than rows
 		GridTransforms funcs = {
 			&getRealCoord,
@@ -1078,14 +925,15 @@ void funAi(GameVars *game) {
 			&transposedSwap
 		};
 		do {
-			funAiColumn(game, &funcs, game->rows - 1 - i, game-> rows - 1);
+			funAiColumn(game, &funcs, game->cols - 1 - i, game->cols - 1);
 		} while (++i);
 	}
 
 	// the unsolved area is now a square
 	// solve rows and columns one after another until we get to a 2x2
-	for (int i = 0; i < game->rows - 2; i++) {
-		const int cornerindex = game->rows - 1 - i;
+	const int size = MIN(game->rows, game->cols);
+	for (int i = 0; i < size - 2; i++) {
+		const int cornerindex = size - 1 - i;
 		GridTransforms funcs = {
 			&getRealCoord,
 			&returnFirst,
@@ -1098,16 +946,168 @@ void funAi(GameVars *game) {
 		funcs.returnNth = &returnSecond;
 		funcs.transformInts = &swapInts;
 		funcs.swap = &transposedSwap;
-		interactiveDebug("transposing");
+		TRACE(TRACE_INFO, "transposing");
 		funAiColumn(game, &funcs, cornerindex, cornerindex - 1);
 	}
 
 	// now solve the 2x2
+	// taking 0 around it clockwise cycles the other 3 cells,
+	// so one of the first 12 layouts on the way is solved
+	PROFILE_PHASE(PHASE_FINAL_SQUARE);
+	const SwapFunction swap = &realSwap;
+	for (int step = 0; step < 12; step++) {
+		const bool solved = !game->y && !game->x && getV(game, 0, 1) == 1
+			&& getV(game, 1, 0) == game->cols && getV(game, 1, 1) == game->cols + 1;
+		if (solved) {
+			return;
+		}
+		if (!game->y && !game->x) {
+			RIGHT();
+		}
+		else if (!game->y) {
+			DOWN();
+		}
+		else if (game->x) {
+			LEFT();
+		}
+		else {
+			UP();
+		}
+	}
+}
+
+// runs funAi off screen from board and writes its moves in to moves
+// returns the number of moves, or -1 if it didn't end up solved or ran out of room
+int greedySolve(const Board *board, char *moves, int capacity) {
+	int cells[board->rows * board->cols];
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		cells[i] = board->cells[i];
+	}
+	OffscreenMoves offscreen = {moves, 0, capacity};
+	GameVars game = {0};
+	game.cells = cells;
+	game.rows = board->rows;
+	game.cols = board->cols;
+	game.y = board->blank / board->cols;
+	game.x = board->blank % board->cols;
+	game.offscreen = &offscreen;
+	if (setjmp(offscreen.abort)) {
+		PROFILE_RESET_PHASE();
+		TRACE(TRACE_WARN, "made an illegal move or ran out of room after %i moves", offscreen.count);
+		return -1;
+	}
+	funAi(&game);
+
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		if (cells[i] != i) {
+			TRACE(TRACE_WARN, "finished with %i at %i", cells[i], i);
+			return -1;
+		}
+	}
+	return offscreen.count;
+}
+
+// plays a solution found off screen on the real board
+void playMoves(GameVars *game, const char *moves, int length) {
+	int coordinates[game->rows * game->cols - 1];
+	game->coordinates = coordinates;
+	fillCoordinates(game);
+	for (int i = 0; i < length; i++) {
+		doMove(game, &realSwap, moves[i]);
+	}
+}
+
+// look up an optimal solution for a 3x3 board
+void tableAi(GameVars *game) {
+	Board board;
+	boardFromGame(game, &board);
+	char moves[EIGHT_DISTANCE_MASK];
+	playMoves(game, moves, eightSolve(&board, moves));
+}
+
+#define AI_SEARCH_MS 5000
+#define AI_SEARCH_NODES (1 << 22)
+
+// solution at most weight times optimal from A*
+// gives up after a while or once it's kept too many boards, and plays greedy instead
+void aStarAi(GameVars *game, const Heuristic *heuristic, double weight) {
+	Board board;
+	boardFromGame(game, &board);
+	char moves[16 * MAX_CELLS];
+	const SearchLimit limit = {monotonicMs() + AI_SEARCH_MS, NULL, AI_SEARCH_NODES};
+	AStarStats stats;
+	const int length = solveWeighted(&board, heuristic, weight, &limit, moves, sizeof(moves), &stats);
+	if (length >= 0) {
+		playMoves(game, moves, length);
+	}
+	else {
+		funAi(game);
+	}
+}
+
+// optimal solution from A* split over a thread per core
+// plays greedy instead if that takes too long or too much memory, like aStarAi
+void hdaAi(GameVars *game) {
+	Board board;
+	boardFromGame(game, &board);
+	char moves[MAX_BIDIR_DEPTH];
+	const SearchLimit limit = {monotonicMs() + AI_SEARCH_MS, NULL, AI_SEARCH_NODES};
+	HdaStats stats;
+	const int length = solveParallel(&board, heuristicFromName("walking"), sysconf(_SC_NPROCESSORS_ONLN),
+		&limit, moves, MAX_BIDIR_DEPTH, &stats);
+	if (length >= 0) {
+		playMoves(game, moves, length);
+	}
+	else {
+		funAi(game);
+	}
+}
+
+// optimal solution from searching from both ends at once
+// plays greedy instead if that takes too long or too much memory, like aStarAi
+void bidirAi(GameVars *game) {
+	Board board;
+	boardFromGame(game, &board);
+	char moves[MAX_BIDIR_DEPTH];
+	const SearchLimit limit = {monotonicMs() + AI_SEARCH_MS, NULL, AI_SEARCH_NODES};
+	BidirStats stats;
+	const int length = solveBidirectional(&board, &limit, moves, MAX_BIDIR_DEPTH, &stats);
+	if (length >= 0) {
+		playMoves(game, moves, length);
+	}
+	else {
+		funAi(game);
+	}
+}
+
+#define ANYTIME_UI_MS 2000
+
+void showBest(const char *moves, int length, void *context) {
+	mvhline(0, 0, ' ', 69);
+	mvprintw(0, 0, "best so far: %i moves", length);
+	refresh();
+}
+
+// improves on the greedy solution for a while, showing how long the best one is as it goes
+void anytimeAi(GameVars *game) {
+	Board board;
+	boardFromGame(game, &board);
+	const int capacity = 64 * MAX_CELLS;
+	char *moves = malloc(capacity);
+	const SearchLimit limit = {monotonicMs() + ANYTIME_UI_MS};
+	AnytimeStats stats;
+	const int length = solveAnytime(&board, &greedySolve, &limit, &showBest, NULL, moves, capacity, &stats);
+	mvhline(0, 0, ' ', 69);
+	if (length >= 0) {
+		playMoves(game, moves, length);
+	}
+	free(moves);
 }
 
 void ai(GameVars *game) {
 	// jumped to by transposedSwap and realSwap when user hits 'c'
 	if (setjmp(exitAi)) {
+		PROFILE_RESET_PHASE();
 		timeout(0);
 		return;
 	}
@@ -1116,6 +1116,14 @@ void ai(GameVars *game) {
 	midPrint(1, "0: Just for fun greedy algorithm");
 	midPrint(2, "1: A* with linear conflict + manhattan distance as heuristic");
 	midPrint(3, "2: https://www.aaai.org/Papers/JAIR/Vol22/JAIR-2209.pdf");
+	midPrint(4, "3: Exact lookup table (3x3 only)");
+	midPrint(5, "4: Bidirectional search (up to 20 cells)");
+	midPrint(6, "5: Best solution found in 2 seconds");
+	midPrint(7, "6: A* with walking distance as heuristic");
+	midPrint(8, "7: A* on every core (up to 32 cells)");
+	char msg[64];
+	weightMsg(msg);
+	midPrint(9, msg);
 
 	int c;
 	while ((c = getch()) != 'c' && c != 'C') {
@@ -1128,6 +1136,47 @@ void ai(GameVars *game) {
 				clearMsgs();
 				funAi(game);
 				return;
+			case '1':
+				clearMsgs();
+				aStarAi(game, heuristicFromName("conflict"), aiWeights[aiWeight]);
+				return;
+			case '3':
+				if (game->rows == 3 && game->cols == 3) {
+					clearMsgs();
+					tableAi(game);
+					return;
+				}
+				break;
+			case '4':
+				if (game->rows * game->cols <= MAX_RANK_CELLS) {
+					clearMsgs();
+					bidirAi(game);
+					return;
+				}
+				break;
+			case '5':
+				clearMsgs();
+				anytimeAi(game);
+				return;
+			case '6':
+				clearMsgs();
+				aStarAi(game, heuristicFromName("walking"), aiWeights[aiWeight]);
+				return;
+			case '7':
+				if (game->rows * game->cols <= HDA_MAX_CELLS) {
+					clearMsgs();
+					hdaAi(game);
+					return;
+				}
+				break;
+			case 'w':
+			case 'W':
+				weightMsg(msg);
+				mvhline(9, (COLS - strlen(msg)) / 2, ' ', strlen(msg));
+				aiWeight = (aiWeight + 1) % AI_WEIGHTS;
+				weightMsg(msg);
+				midPrint(9, msg);
+				break;
 		}
 	}
 	clearMsgs();
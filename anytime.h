@@ -0,0 +1,252 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "astar.h"
+#include "heuristic.h"
+
+// anytime solving: get some solution right away, then keep improving it until a deadline
+// or until cancelled, handing every improvement to a callback
+//
+// the first solution comes from a quick solver (funAi's greedy solution when run from ai.h),
+// or weighted A* with a big weight if that fails. then it takes turns between shortcutting
+// the best solution so far, by searching a few moves around every board on it for a later
+// board on it, and weighted A* with smaller and smaller weights that only looks for
+// solutions shorter than the best so far. once weight 1 runs out of boards the best is optimal
+
+#define ANYTIME_MAX_NODES (1 << 22) // boards each weighted search may keep
+#define ANYTIME_MAX_SHORTCUT 12 // deepest search around each board when shortcutting
+
+typedef int (*QuickSolver)(const Board *board, char *moves, int capacity);
+typedef void (*ImprovedCallback)(const char *moves, int length, void *context);
+
+typedef struct AnytimeStats {
+	int initial; // length of the first solution
+	int rounds;
+	bool optimal; // whether the final solution was proven optimal
+} AnytimeStats;
+
+static inline uint64_t cellKey(int cell, int value) {
+	uint64_t x = (uint64_t)(cell << 8 | value) * 0x9e3779b97f4a7c15;
+	x ^= x >> 31;
+	x *= 0xbf58476d1ce4e5b9;
+	return x ^ x >> 29;
+}
+
+// zobrist style key of a board, so a move only changes 4 terms
+uint64_t boardKey(const Board *board) {
+	uint64_t key = 0;
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		key ^= cellKey(i, board->cells[i]);
+	}
+	return key;
+}
+
+// how the key changes when 0 makes move
+static inline uint64_t moveKey(const Board *board, int move) {
+	const int to = board->blank + moveOffset(board, move);
+	const int tile = board->cells[to];
+	return cellKey(board->blank, 0) ^ cellKey(to, tile) ^ cellKey(board->blank, tile) ^ cellKey(to, 0);
+}
+
+// every board along a solution, looked up by key
+typedef struct PathIndex {
+	int n;
+	int length;
+	unsigned char *boards; // length + 1 boards of n cells
+	uint64_t *keys;
+	int *table; // index + 1 of the last board with the key, 0 is empty
+	uint32_t mask;
+} PathIndex;
+
+void indexPath(PathIndex *path, const Board *start, const char *moves, int length) {
+	const int n = start->rows * start->cols;
+	path->n = n;
+	path->length = length;
+	path->boards = realloc(path->boards, (length + 1) * (long)n);
+	path->keys = realloc(path->keys, (length + 1) * sizeof(uint64_t));
+	path->mask = 1;
+	while (path->mask < 2 * (uint32_t)(length + 1)) {
+		path->mask = path->mask * 2 + 1;
+	}
+	free(path->table);
+	path->table = calloc(path->mask + 1, sizeof(int));
+
+	Board board = *start;
+	uint64_t key = boardKey(&board);
+	for (int i = 0; i <= length; i++) {
+		memcpy(&path->boards[i * (long)n], board.cells, n);
+		path->keys[i] = key;
+		uint32_t slot = key & path->mask;
+		while (path->table[slot] && path->keys[path->table[slot] - 1] != key) {
+			slot = (slot + 1) & path->mask;
+		}
+		path->table[slot] = i + 1;
+		if (i < length) {
+			const int move = moveFromChar(moves[i]);
+			key ^= moveKey(&board, move);
+			applyMove(&board, move);
+		}
+	}
+}
+
+// returns the last index of board on the path, or -1
+int findOnPath(const PathIndex *path, const Board *board, uint64_t key) {
+	uint32_t slot = key & path->mask;
+	while (path->table[slot]) {
+		const int i = path->table[slot] - 1;
+		if (path->keys[i] == key && !memcmp(&path->boards[i * (long)path->n], board->cells, path->n)) {
+			return i;
+		}
+		slot = (slot + 1) & path->mask;
+	}
+	return -1;
+}
+
+void freePath(PathIndex *path) {
+	free(path->boards);
+	free(path->keys);
+	free(path->table);
+}
+
+// removes every part of a solution that comes back to a board it already passed through
+int removeLoops(const Board *start, char *moves, int length) {
+	PathIndex path = {0};
+	indexPath(&path, start, moves, length);
+	int kept = 0;
+	for (int i = 0; i < length;) {
+		// jump to the last time this board comes up
+		Board board = {start->rows, start->cols};
+		memcpy(board.cells, &path.boards[i * (long)path.n], path.n);
+		const int j = findOnPath(&path, &board, path.keys[i]);
+		if (j == length) {
+			break;
+		}
+		moves[kept++] = moves[j];
+		i = j + 1;
+	}
+	freePath(&path);
+	return kept;
+}
+
+typedef struct Shortcut {
+	int from;
+	int to; // index on the path it rejoins at
+	int length;
+	char moves[ANYTIME_MAX_SHORTCUT];
+} Shortcut;
+
+// depth first search from a board on the path for a later board on the path
+// that's more moves along the path than it is from here
+static void findShortcut(const PathIndex *path, Board *board, uint64_t key, int depth, int maxDepth,
+		int lastMove, char *trail, Shortcut *best) {
+	if (depth) {
+		const int i = findOnPath(path, board, key);
+		if (i - best->from - depth > best->to - best->from - best->length) {
+			best->to = i;
+			best->length = depth;
+			memcpy(best->moves, trail, depth);
+		}
+	}
+	if (depth == maxDepth) {
+		return;
+	}
+	for (int move = 0; move < 4; move++) {
+		if (move == OPPOSITE_MOVE(lastMove) || !canMove(board, move)) {
+			continue;
+		}
+		trail[depth] = moveChars[move];
+		const uint64_t next = key ^ moveKey(board, move);
+		applyMove(board, move);
+		findShortcut(path, board, next, depth + 1, maxDepth, move, trail, best);
+		applyMove(board, OPPOSITE_MOVE(move));
+	}
+}
+
+// replaces stretches of a solution with shorter ones found within maxDepth moves
+// returns the new length
+int shortcutMoves(const Board *start, char *moves, int length, int maxDepth, const SearchLimit *limit) {
+	PathIndex path = {0};
+	indexPath(&path, start, moves, length);
+	char trail[ANYTIME_MAX_SHORTCUT];
+	for (int i = 0; i < length && !limitReached(limit, 0);) {
+		Board board = {start->rows, start->cols};
+		memcpy(board.cells, &path.boards[i * (long)path.n], path.n);
+		for (board.blank = 0; board.cells[board.blank]; board.blank++);
+		Shortcut best = {i, i, 0};
+		findShortcut(&path, &board, path.keys[i], 0, maxDepth, -1, trail, &best);
+		if (best.to - i <= best.length) {
+			i++;
+			continue;
+		}
+		memmove(&moves[i + best.length], &moves[best.to], length - best.to);
+		memcpy(&moves[i], best.moves, best.length);
+		length -= best.to - i - best.length;
+		indexPath(&path, start, moves, length);
+	}
+	freePath(&path);
+	return length;
+}
+
+// writes the best solution found before limit in to best and returns its length, or -1 if
+// nothing was found. quick may be NULL
+int solveAnytime(const Board *board, QuickSolver quick, const SearchLimit *limit,
+		ImprovedCallback improved, void *context, char *best, int capacity, AnytimeStats *stats) {
+	const double weights[] = {5, 3, 2, 1.5, 1.25, 1};
+	const int weightCount = sizeof(weights) / sizeof(*weights);
+	memset(stats, 0, sizeof(AnytimeStats));
+	char *moves = malloc(capacity);
+	SearchLimit searchLimit = *limit;
+	searchLimit.maxNodes = ANYTIME_MAX_NODES;
+	AStarStats searchStats;
+
+	int length = quick == NULL ? -1 : quick(board, best, capacity);
+	if (length < 0) {
+		length = solveWeighted(board, &heuristics[1], weights[0], &searchLimit, best, capacity, &searchStats);
+	}
+	stats->initial = length;
+	if (length < 0) {
+		free(moves);
+		return -1;
+	}
+	improved(best, length, context);
+
+	int shorter = removeLoops(board, best, length);
+	if (shorter < length) {
+		length = shorter;
+		improved(best, length, context);
+	}
+
+	int depth = 6;
+	int weight = 1;
+	while (!limitReached(limit, 0) && !stats->optimal && (depth <= ANYTIME_MAX_SHORTCUT || weight < weightCount)) {
+		stats->rounds++;
+		if (depth <= ANYTIME_MAX_SHORTCUT) {
+			shorter = shortcutMoves(board, best, length, depth, limit);
+			if (shorter < length) {
+				length = shorter;
+				improved(best, length, context);
+			}
+			depth += 2;
+		}
+		if (weight < weightCount) {
+			searchLimit.maxLength = length;
+			shorter = solveWeighted(board, &heuristics[1], weights[weight], &searchLimit, moves, capacity, &searchStats);
+			if (shorter >= 0) {
+				length = shorter;
+				memcpy(best, moves, length);
+				improved(best, length, context);
+			}
+			// nothing shorter than the best exists if a search runs out of boards,
+			// whatever the weight
+			stats->optimal = !searchStats.stopped && (shorter < 0 || weights[weight] == 1);
+			weight++;
+		}
+	}
+	free(moves);
+	return length;
+}
@@ -0,0 +1,304 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "pdb.h"
+#include "walking.h"
+#include "profile.h"
+
+// weighted A*: expands boards in order of g + weight * h
+//
+// with an admissible h (all of these are) the solution found is at most weight times
+// longer than optimal, as long as boards are reopened when a shorter path to them
+// turns up, which they are. weight 1 is plain A* and optimal.
+// every board seen is kept, in a pool of cells with an open addressed hash table over it
+
+const Heuristic heuristics[] = {
+	{"manhattan", &manhattan},
+	{"conflict", &linearConflict},
+	{"pdb", &patternEstimate},
+	{"walking", &walkingDistance, &walkingStartState, &walkingMoveState, &walkingStateValue},
+	{"packed", &packedEstimate}
+};
+#define HEURISTIC_COUNT (sizeof(heuristics) / sizeof(*heuristics))
+
+// returns the heuristic with the given name, or NULL if there isn't one
+const Heuristic *heuristicFromName(const char *name) {
+	for (int i = 0; i < HEURISTIC_COUNT; i++) {
+		if (!strcmp(name, heuristics[i].name)) {
+			return &heuristics[i];
+		}
+	}
+	return NULL;
+}
+
+// optional limits on a search, zero for none
+typedef struct SearchLimit {
+	double deadlineMs; // on the CLOCK_MONOTONIC clock
+	volatile bool *cancel; // stop once this is set
+	long maxNodes; // stop once this many boards have been seen
+	int maxLength; // only look for solutions shorter than this
+} SearchLimit;
+
+double monotonicMs() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e3 + t.tv_nsec / 1e6;
+}
+
+// whether a search should give up now
+bool limitReached(const SearchLimit *limit, long nodes) {
+	return limit != NULL && ((limit->cancel != NULL && *limit->cancel)
+		|| (limit->maxNodes && nodes >= limit->maxNodes)
+		|| (limit->deadlineMs && monotonicMs() >= limit->deadlineMs));
+}
+
+typedef struct AStarStats {
+	long expanded;
+	long generated;
+	long reopened;
+	int lowerBound; // no solution is shorter than this
+	bool stopped; // gave up because of the limit rather than running out of boards
+} AStarStats;
+
+typedef struct SearchNode {
+	int parent;
+	int g;
+	int h;
+	char move; // that got here from parent
+	bool closed;
+} SearchNode;
+
+typedef struct OpenEntry {
+	double f;
+	int g;
+	int node;
+} OpenEntry;
+
+typedef struct AStarSearch {
+	int n; // cells per board
+	SearchNode *nodes;
+	unsigned char *cells; // n per node
+	int count;
+	int capacity;
+	int *table; // node index + 1, 0 is empty
+	uint32_t tableMask;
+	OpenEntry *open; // binary heap
+	int openCount;
+	int openCapacity;
+	HeuristicState *states; // per node, for a heuristic that follows moves, NULL for others
+} AStarSearch;
+
+static uint64_t hashCells(const unsigned char *cells, int n) {
+	uint64_t hash = 0xcbf29ce484222325;
+	for (int i = 0; i < n; i++) {
+		hash = (hash ^ cells[i]) * 0x100000001b3;
+	}
+	return hash ^ hash >> 29;
+}
+
+// returns the slot board is in, or the empty slot it would go in
+static int *findSlot(AStarSearch *s, const unsigned char *cells) {
+	uint32_t i = hashCells(cells, s->n) & s->tableMask;
+	while (s->table[i] && memcmp(&s->cells[(s->table[i] - 1) * (long)s->n], cells, s->n)) {
+		i = (i + 1) & s->tableMask;
+	}
+	return &s->table[i];
+}
+
+static void growTable(AStarSearch *s) {
+	free(s->table);
+	s->tableMask = s->tableMask * 2 + 1;
+	s->table = calloc(s->tableMask + 1, sizeof(int));
+	for (int node = 0; node < s->count; node++) {
+		*findSlot(s, &s->cells[node * (long)s->n]) = node + 1;
+	}
+}
+
+static int addNode(AStarSearch *s, const unsigned char *cells, int *slot) {
+	if (s->count == s->capacity) {
+		s->capacity *= 2;
+		s->nodes = realloc(s->nodes, s->capacity * sizeof(SearchNode));
+		s->cells = realloc(s->cells, s->capacity * (long)s->n);
+		if (s->states != NULL) {
+			s->states = realloc(s->states, s->capacity * sizeof(HeuristicState));
+		}
+	}
+	const int node = s->count++;
+	memcpy(&s->cells[node * (long)s->n], cells, s->n);
+	*slot = node + 1;
+	// keep the table at most half full
+	if (2 * (uint32_t)s->count > s->tableMask) {
+		growTable(s);
+	}
+	return node;
+}
+
+// lower f first, and deeper first among equal f since it's closer to a goal
+static bool entryBefore(const OpenEntry *a, const OpenEntry *b) {
+	return a->f < b->f || (a->f == b->f && a->g > b->g);
+}
+
+static void pushOpen(AStarSearch *s, OpenEntry entry) {
+	if (s->openCount == s->openCapacity) {
+		s->openCapacity *= 2;
+		s->open = realloc(s->open, s->openCapacity * sizeof(OpenEntry));
+	}
+	int i = s->openCount++;
+	while (i && entryBefore(&entry, &s->open[(i - 1) / 2])) {
+		s->open[i] = s->open[(i - 1) / 2];
+		i = (i - 1) / 2;
+	}
+	s->open[i] = entry;
+}
+
+static OpenEntry popOpen(AStarSearch *s) {
+	const OpenEntry top = s->open[0];
+	const OpenEntry last = s->open[--s->openCount];
+	int i = 0;
+	while (2 * i + 1 < s->openCount) {
+		int child = 2 * i + 1;
+		if (child + 1 < s->openCount && entryBefore(&s->open[child + 1], &s->open[child])) {
+			child++;
+		}
+		if (!entryBefore(&s->open[child], &last)) {
+			break;
+		}
+		s->open[i] = s->open[child];
+		i = child;
+	}
+	s->open[i] = last;
+	return top;
+}
+
+static void freeSearch(AStarSearch *s) {
+	free(s->nodes);
+	free(s->cells);
+	free(s->table);
+	free(s->open);
+	free(s->states);
+}
+
+// writes a solution at most weight times optimal in to moves and returns its length
+// returns -1 if it won't fit in capacity, if limit stopped the search,
+// or if there's no solution shorter than limit->maxLength
+int solveWeighted(const Board *start, const Heuristic *heuristic, double weight, const SearchLimit *limit,
+		char *moves, int capacity, AStarStats *stats) {
+	memset(stats, 0, sizeof(AStarStats));
+	PROFILE_SEARCH(SEARCH_WEIGHTED);
+	const int n = start->rows * start->cols;
+	AStarSearch s = {0};
+	s.n = n;
+	s.capacity = 1 << 12;
+	s.nodes = malloc(s.capacity * sizeof(SearchNode));
+	s.cells = malloc(s.capacity * (long)n);
+	s.tableMask = (1 << 13) - 1;
+	s.table = calloc(s.tableMask + 1, sizeof(int));
+	s.openCapacity = 1 << 12;
+	s.open = malloc(s.openCapacity * sizeof(OpenEntry));
+	if (heuristic->follow != NULL) {
+		s.states = malloc(s.capacity * sizeof(HeuristicState));
+	}
+
+	const int startH = heuristic->estimate(start);
+	const int root = addNode(&s, start->cells, findSlot(&s, start->cells));
+	s.nodes[root] = (SearchNode){-1, 0, startH, 0, false};
+	if (s.states != NULL) {
+		s.states[root] = heuristic->start(start);
+	}
+	pushOpen(&s, (OpenEntry){weight * startH, 0, root});
+
+	Board board = *start;
+	int goal = -1;
+	while (s.openCount) {
+		const OpenEntry entry = popOpen(&s);
+		SearchNode *node = &s.nodes[entry.node];
+		// stale entry left behind when a shorter path was found
+		if (node->closed || entry.g != node->g) {
+			continue;
+		}
+		node->closed = true;
+		memcpy(board.cells, &s.cells[entry.node * (long)n], n);
+		for (board.blank = 0; board.cells[board.blank]; board.blank++);
+		if (isGoal(&board)) {
+			goal = entry.node;
+			break;
+		}
+		stats->expanded++;
+		// checking the clock is slow enough that it's only done now and then
+		if (!(stats->expanded & 1023) && limitReached(limit, s.count)) {
+			stats->stopped = true;
+			break;
+		}
+
+		const int g = node->g + 1;
+		const int parentMove = node->parent < 0 ? -1 : moveFromChar(node->move);
+		const HeuristicState parentState = s.states != NULL ? s.states[entry.node] : 0;
+		for (int move = 0; move < 4; move++) {
+			if (!canMove(&board, move) || (parentMove >= 0 && move == OPPOSITE_MOVE(parentMove))) {
+				continue;
+			}
+			const HeuristicState state = s.states != NULL ? heuristic->follow(parentState, &board, move) : 0;
+			applyMove(&board, move);
+			int *slot = findSlot(&s, board.cells);
+			int child;
+			if (*slot) {
+				child = *slot - 1;
+				if (s.nodes[child].g <= g) {
+					applyMove(&board, OPPOSITE_MOVE(move));
+					continue;
+				}
+				stats->reopened += s.nodes[child].closed;
+				s.nodes[child].closed = false;
+			}
+			else {
+				const int h = s.states != NULL ? heuristic->value(state, &board) : heuristic->estimate(&board);
+				if (limit != NULL && limit->maxLength && g + h >= limit->maxLength) {
+					applyMove(&board, OPPOSITE_MOVE(move));
+					continue;
+				}
+				child = addNode(&s, board.cells, slot);
+				if (s.states != NULL) {
+					s.states[child] = state;
+				}
+				s.nodes[child].h = h;
+				s.nodes[child].closed = false;
+				stats->generated++;
+			}
+			s.nodes[child].parent = entry.node;
+			s.nodes[child].g = g;
+			s.nodes[child].move = moveChars[move];
+			pushOpen(&s, (OpenEntry){g + weight * s.nodes[child].h, g, child});
+			applyMove(&board, OPPOSITE_MOVE(move));
+		}
+	}
+
+	int length = -1;
+	if (goal >= 0) {
+		length = s.nodes[goal].g;
+		// the solution is at most weight times optimal, and all solutions have the same parity
+		int bound = length / weight;
+		if (bound * weight < length - 1e-9) {
+			bound++;
+		}
+		bound = bound > startH ? bound : startH;
+		stats->lowerBound = bound + ((length - bound) & 1);
+		if (length <= capacity) {
+			for (int node = goal, i = length - 1; i >= 0; node = s.nodes[node].parent, i--) {
+				moves[i] = s.nodes[node].move;
+			}
+		}
+		else {
+			length = -1;
+		}
+	}
+	freeSearch(&s);
+	PROFILE_ITERATION(SEARCH_WEIGHTED, 0, stats->expanded);
+	return length;
+}
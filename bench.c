@@ -0,0 +1,269 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "ranking.h"
+#include "random_board.h"
+#include "astar.h"
+
+// micro benchmarks for the building blocks the solvers share
+// usage: ./bench [-n iterations] [benchmark ...]
+
+long iterations = 1000000;
+volatile uint64_t sink; // keeps the compiler from throwing away the work
+
+double nowNs() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+// fills perms with count random permutations of 0 to n - 1
+void randomPerms(unsigned char *perms, long count, int n) {
+	for (long i = 0; i < count; i++) {
+		unsigned char *perm = perms + i * n;
+		for (int j = 0; j < n; j++) {
+			perm[j] = j;
+		}
+		for (int j = n - 1; j > 0; j--) {
+			const int k = rand() % (j + 1);
+			const unsigned char temp = perm[j];
+			perm[j] = perm[k];
+			perm[k] = temp;
+		}
+	}
+}
+
+void report(const char *name, int n, double ns) {
+	printf("%-20s n=%-3i %8.2f ns\n", name, n, ns / iterations);
+}
+
+void benchRanking() {
+	const int sizes[] = {9, 12, 16, 20};
+	const long count = 4096; // small enough to stay in cache so only ranking is measured
+	for (int s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+		const int n = sizes[s];
+		unsigned char *perms = malloc(count * n);
+		randomPerms(perms, count, n);
+		uint64_t ranks[count];
+		unsigned char out[MAX_RANK_CELLS];
+
+		uint64_t sum = 0;
+		double start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			sum += rankPerm(perms + (i % count) * n, n);
+		}
+		report("rankPerm", n, nowNs() - start);
+
+		for (long i = 0; i < count; i++) {
+			ranks[i] = rankPerm(perms + i * n, n);
+		}
+		start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			sum += unrankPerm(ranks[i % count], n, out);
+			sum += out[i % n];
+		}
+		report("unrankPerm", n, nowNs() - start);
+
+		start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			sum += rankPermMR(perms + (i % count) * n, n);
+		}
+		report("rankPermMR", n, nowNs() - start);
+
+		start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			unrankPermMR(ranks[i % count], n, out);
+			sum += out[i % n];
+		}
+		report("unrankPermMR", n, nowNs() - start);
+
+		// the first 6 entries of a permutation are a random placement of 6 tiles
+		const int k = 6;
+		start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			sum += rankPartial(perms + (i % count) * n, k, n);
+		}
+		report("rankPartial k=6", n, nowNs() - start);
+
+		for (long i = 0; i < count; i++) {
+			ranks[i] = rankPartial(perms + i * n, k, n);
+		}
+		start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			unrankPartial(ranks[i % count], k, n, out);
+			sum += out[i % k];
+		}
+		report("unrankPartial k=6", n, nowNs() - start);
+
+		sink = sum;
+		free(perms);
+	}
+}
+
+void benchSolvable() {
+	const int sizes[] = {9, 16, 25, 100};
+	const long count = 4096;
+	for (int s = 0; s < sizeof(sizes) / sizeof(*sizes); s++) {
+		const int n = sizes[s];
+		unsigned char *perms = malloc(count * n);
+		randomPerms(perms, count, n);
+
+		uint64_t sum = 0;
+		const double start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			sum += permutationParity(perms + (i % count) * n, n);
+		}
+		report("permutationParity", n, nowNs() - start);
+
+		sink = sum;
+		free(perms);
+	}
+}
+
+void benchRandom() {
+	const int shapes[][2] = {{3, 3}, {4, 4}, {4, 5}, {5, 5}};
+	Board boards[RANDOM_BATCH];
+	uint64_t state = 1;
+	for (int s = 0; s < sizeof(shapes) / sizeof(*shapes); s++) {
+		const int rows = shapes[s][0];
+		const int cols = shapes[s][1];
+		const int n = rows * cols;
+
+		uint64_t sum = 0;
+		double start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			randomSolvableBoard(&state, rows, cols, &boards[0]);
+			sum += boards[0].blank;
+		}
+		report("randomSolvableBoard", n, nowNs() - start);
+
+		start = nowNs();
+		for (long i = 0; i < iterations; i += RANDOM_BATCH) {
+			randomSolvableBoards(&state, rows, cols, boards, RANDOM_BATCH);
+			sum += boards[i % RANDOM_BATCH].blank;
+		}
+		report("randomSolvableBoards", n, nowNs() - start);
+
+		sink = sum;
+	}
+}
+
+// time per estimate and average estimate of every heuristic on random boards,
+// and following walking distance move by move instead of from scratch
+void benchHeuristics() {
+	const int shapes[][2] = {{3, 3}, {4, 4}, {3, 5}};
+	const long count = 4096;
+	Board *boards = malloc(count * sizeof(Board));
+	uint64_t state = 1;
+	for (int s = 0; s < sizeof(shapes) / sizeof(*shapes); s++) {
+		const int rows = shapes[s][0];
+		const int cols = shapes[s][1];
+		const int n = rows * cols;
+		randomSolvableBoards(&state, rows, cols, boards, count);
+		for (int h = 0; h < HEURISTIC_COUNT; h++) {
+			heuristics[h].estimate(&boards[0]); // builds any tables
+			long sum = 0;
+			for (long i = 0; i < count; i++) {
+				sum += heuristics[h].estimate(&boards[i]);
+			}
+			const double start = nowNs();
+			for (long i = 0; i < iterations; i++) {
+				sink += heuristics[h].estimate(&boards[i % count]);
+			}
+			char name[32];
+			snprintf(name, sizeof(name), "%s (%.1f)", heuristics[h].name, (double)sum / count);
+			report(name, n, nowNs() - start);
+		}
+
+		const WalkingTables *tables = walkingTables(rows, cols);
+		Board board = boards[0];
+		WalkingState walking = walkingStart(tables, &board);
+		uint64_t sum = 0;
+		const double start = nowNs();
+		for (long i = 0; i < iterations; i++) {
+			const int move = nextRandom(&state) & 3;
+			if (canMove(&board, move)) {
+				walking = walkingMove(tables, walking, &board, move);
+				applyMove(&board, move);
+			}
+			sum += walkingValue(tables, walking);
+		}
+		report("walking per move", n, nowNs() - start);
+		sink = sum;
+	}
+	free(boards);
+}
+
+// pattern database build time and states expanded per second, for each number of threads
+// up to one per core
+void benchPatterns() {
+	const int shapes[][2] = {{3, 4}, {4, 4}, {5, 5}};
+	const int cores = patternThreads();
+	for (int s = 0; s < sizeof(shapes) / sizeof(*shapes); s++) {
+		const int rows = shapes[s][0];
+		const int cols = shapes[s][1];
+		for (int threads = 1;; threads = threads * 2 < cores ? threads * 2 : cores) {
+			PatternDatabase pdb;
+			const double start = nowNs();
+			const long states = buildPatternDatabase(&pdb, rows, cols, threads);
+			const double ns = nowNs() - start;
+			freePatternDatabase(&pdb);
+			char name[32];
+			snprintf(name, sizeof(name), "%ix%i threads=%i", rows, cols, threads);
+			printf("%-20s n=%-3i %8.2f ms %8.2f Mstates/s\n", name, rows * cols, ns / 1e6, states / ns * 1e3);
+			if (threads == cores) {
+				break;
+			}
+		}
+	}
+}
+
+typedef struct Benchmark {
+	const char *name;
+	void (*run)();
+} Benchmark;
+
+Benchmark benchmarks[] = {
+	{"rank", &benchRanking},
+	{"solvable", &benchSolvable},
+	{"random", &benchRandom},
+	{"heuristic", &benchHeuristics},
+	{"pdb", &benchPatterns}
+};
+
+int main(int argc, char *argv[]) {
+	opterr = 0;
+	int c;
+	while ((c = getopt(argc, argv, "n:")) != -1) {
+		switch (c) {
+			case 'n':
+				iterations = atol(optarg);
+				break;
+			case ':':
+				fprintf(stderr, "Iterations option must take value\n");
+				exit(1);
+			case '?':
+				fprintf(stderr, "Unknown option %c\n", optopt);
+				exit(2);
+		}
+	}
+	srand(0);
+
+	const int count = sizeof(benchmarks) / sizeof(*benchmarks);
+	for (int i = 0; i < count; i++) {
+		bool selected = optind == argc;
+		for (int j = optind; j < argc; j++) {
+			selected |= !strcmp(argv[j], benchmarks[i].name);
+		}
+		if (selected) {
+			printf("%s:\n", benchmarks[i].name);
+			benchmarks[i].run();
+		}
+	}
+}
@@ -0,0 +1,465 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "board.h"
+#include "ranking.h"
+#include "records.h"
+#include "sorted_keys.h"
+
+// breadth first search over every solvable board of a size, from the goal
+// prints how many boards there are at each distance and can write the hardest ones out
+//
+// what's been seen is kept one of two ways:
+// 	bitmap: 2 bits per solvable rank (see rankSolvable), in a file mapped in to memory.
+// 		each entry is UNSEEN, DONE or one of 2 codes that alternate between layers.
+// 		a layer is expanded in one pass, marking unseen neighbours with the other code,
+// 		and retired to DONE in a second pass, so rerunning either pass changes nothing
+// 	layers: each layer is a file of sorted ranks. the neighbours of a layer are generated
+// 		in to memory sized runs that are sorted and written out, then merged while
+// 		dropping duplicates and anything in the layer before. every move changes the parity
+// 		of the permutation, so neighbours are only ever in the layer before or after, and only
+// 		those two are kept while the next is made
+//
+// either way progress is saved after every pass; running again with the same arguments
+// carries on from there
+
+#define MAX_DEPTH 1024
+#define UNSEEN 3
+#define DONE 0
+#define CODE(depth) (1 + ((depth) & 1))
+#define FINISHED 3 // pass saved once the last layer is known
+
+int rows;
+int cols;
+const char *directory = ".";
+long memoryBytes = 1L << 30;
+FILE *hardest = NULL;
+long counts[MAX_DEPTH];
+
+void usage() {
+	fprintf(stderr, "Usage: ./bfs [-e] [-M megabytes] [-d directory] [-o hardest] rows cols\n"
+			"-e keeps layers in sorted files instead of a bitmap, for when the bitmap won't fit\n"
+			"-M sets how much memory to use (default 1024), the bitmap is used if it fits\n"
+			"-d sets where to keep the bitmap or layers and progress (default .)\n"
+			"-o writes the boards furthest from the goal to a text records file\n"
+			"boards may have at most %i cells\n", MAX_RANK_CELLS);
+	exit(4);
+}
+
+char *pathTo(const char *name) {
+	static char path[4096];
+	snprintf(path, sizeof(path), "%s/%s", directory, name);
+	return path;
+}
+
+// progress is the last finished pass and the layer sizes known so far
+// written to a temporary file and renamed over the old one so it's never half written
+void saveProgress(int depth, int pass) {
+	char temp[4096];
+	snprintf(temp, sizeof(temp), "%s.tmp", pathTo("progress"));
+	FILE *f = fopen(temp, "w");
+	if (f == NULL) {
+		perror(temp);
+		exit(5);
+	}
+	fprintf(f, "%i %i %i %i\n", rows, cols, depth, pass);
+	for (int d = 0; d <= depth; d++) {
+		fprintf(f, "%li\n", counts[d]);
+	}
+	fflush(f);
+	fsync(fileno(f));
+	fclose(f);
+	rename(temp, pathTo("progress"));
+}
+
+// returns whether there was progress for this board size
+bool loadProgress(int *depth, int *pass) {
+	FILE *f = fopen(pathTo("progress"), "r");
+	if (f == NULL) {
+		return false;
+	}
+	int r, c;
+	if (fscanf(f, "%i %i %i %i", &r, &c, depth, pass) != 4 || r != rows || c != cols) {
+		fprintf(stderr, "%s is for a different search\n", pathTo("progress"));
+		exit(1);
+	}
+	for (int d = 0; d <= *depth; d++) {
+		if (fscanf(f, "%li", &counts[d]) != 1) {
+			counts[d] = 0;
+		}
+	}
+	fclose(f);
+	return true;
+}
+
+void writeHardest(uint64_t rank) {
+	RecordHeader header = {rows, cols, ALGORITHM_NONE};
+	Board board;
+	unrankSolvable(rank, rows, cols, &board);
+	writeTextRecord(hardest, &header, &board, NULL, 0);
+}
+
+static inline int getCode(const unsigned char *bits, uint64_t rank) {
+	return bits[rank >> 2] >> (rank & 3) * 2 & 3;
+}
+
+static inline void setCode(unsigned char *bits, uint64_t rank, int code) {
+	const int shift = (rank & 3) * 2;
+	bits[rank >> 2] = (bits[rank >> 2] & ~(3 << shift)) | code << shift;
+}
+
+// returns the depth of the last layer
+int bitmapSearch() {
+	const uint64_t states = solvableCount(rows, cols);
+	const uint64_t bytes = (states + 3) / 4;
+	int depth = 0;
+	int pass = 0;
+	const bool resuming = loadProgress(&depth, &pass);
+
+	const int fd = open(pathTo("bitmap"), O_RDWR | O_CREAT, 0644);
+	if (fd < 0 || ftruncate(fd, bytes)) {
+		perror(pathTo("bitmap"));
+		exit(5);
+	}
+	unsigned char *bits = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	if (bits == MAP_FAILED) {
+		perror("mmap");
+		exit(5);
+	}
+	if (!resuming) {
+		memset(bits, 0xff, bytes);
+		Board goal;
+		goalBoard(&goal, rows, cols);
+		setCode(bits, rankSolvable(&goal), CODE(0));
+		pass = 2; // as if layer -1 had been retired
+		depth = -1;
+	}
+
+	Board board;
+	while (pass != FINISHED) {
+		if (pass == 2) {
+			depth++;
+			pass = 0;
+		}
+		const int code = CODE(depth);
+		const int next = CODE(depth + 1);
+		if (pass == 0) {
+			// expand the layer, counting it
+			// the layer is only counted here since retiring it might be interrupted part way
+			long size = 0;
+			for (uint64_t rank = 0; rank < states; rank++) {
+				// skip bytes with nothing in this layer quickly
+				if (!(rank & 3) && (bits[rank >> 2] == 0xff || !bits[rank >> 2])) {
+					rank += 3;
+					continue;
+				}
+				if (getCode(bits, rank) != code) {
+					continue;
+				}
+				size++;
+				unrankSolvable(rank, rows, cols, &board);
+				for (int move = 0; move < 4; move++) {
+					if (!canMove(&board, move)) {
+						continue;
+					}
+					applyMove(&board, move);
+					const uint64_t neighbour = rankSolvable(&board);
+					if (getCode(bits, neighbour) == UNSEEN) {
+						setCode(bits, neighbour, next);
+					}
+					applyMove(&board, OPPOSITE_MOVE(move));
+				}
+			}
+			msync(bits, bytes, MS_SYNC);
+			counts[depth] = size;
+			saveProgress(depth, pass = 1);
+		}
+
+		// retire the layer, unless there's nothing after it
+		bool last = true;
+		for (uint64_t rank = 0; rank < states && last; rank++) {
+			last = getCode(bits, rank) != next;
+		}
+		if (last) {
+			saveProgress(depth, pass = FINISHED);
+			break;
+		}
+		for (uint64_t rank = 0; rank < states; rank++) {
+			if (getCode(bits, rank) == code) {
+				setCode(bits, rank, DONE);
+			}
+		}
+		msync(bits, bytes, MS_SYNC);
+		saveProgress(depth, pass = 2);
+	}
+
+	// the last layer is never retired
+	if (hardest != NULL) {
+		for (uint64_t rank = 0; rank < states; rank++) {
+			if (getCode(bits, rank) == CODE(depth)) {
+				writeHardest(rank);
+			}
+		}
+	}
+	munmap(bits, bytes);
+	close(fd);
+	return depth;
+}
+
+char *layerPath(int depth) {
+	char name[64];
+	snprintf(name, sizeof(name), "layer-%03i", depth);
+	return pathTo(name);
+}
+
+FILE *openLayer(int depth, const char *mode) {
+	FILE *f = fopen(layerPath(depth), mode);
+	if (f == NULL) {
+		perror(layerPath(depth));
+		exit(5);
+	}
+	return f;
+}
+
+// a sorted file read one key at a time
+typedef struct KeyStream {
+	FILE *f;
+	uint64_t key;
+	bool done;
+} KeyStream;
+
+void advance(KeyStream *s) {
+	s->done = s->f == NULL || fread(&s->key, sizeof(uint64_t), 1, s->f) != 1;
+}
+
+// sorts the keys, drops duplicates and writes them out as a run
+// runs are deleted as soon as they're created so they go away however the program ends
+FILE *writeRun(uint64_t *keys, long count, uint64_t *temp) {
+	static int runs = 0;
+	char name[64];
+	snprintf(name, sizeof(name), "run-%i", runs++);
+	FILE *run = fopen(pathTo(name), "w+b");
+	if (run == NULL) {
+		perror(pathTo(name));
+		exit(5);
+	}
+	unlink(pathTo(name));
+	sortKeys(keys, count, temp);
+	count = uniqueKeys(keys, count);
+	if (fwrite(keys, sizeof(uint64_t), count, run) != count) {
+		perror("run");
+		exit(5);
+	}
+	return run;
+}
+
+// builds layer depth + 1 from layer depth, returns its size
+long nextLayer(int depth) {
+	const long bufferKeys = memoryBytes / (2 * sizeof(uint64_t));
+	uint64_t *keys = malloc(bufferKeys * sizeof(uint64_t));
+	uint64_t *temp = malloc(bufferKeys * sizeof(uint64_t));
+
+	// generate sorted runs of neighbours
+	FILE *runs[MAX_DEPTH];
+	int runCount = 0;
+	long count = 0;
+	FILE *layer = openLayer(depth, "rb");
+	uint64_t rank;
+	Board board;
+	while (fread(&rank, sizeof(uint64_t), 1, layer) == 1) {
+		unrankSolvable(rank, rows, cols, &board);
+		for (int move = 0; move < 4; move++) {
+			if (!canMove(&board, move)) {
+				continue;
+			}
+			applyMove(&board, move);
+			keys[count++] = rankSolvable(&board);
+			applyMove(&board, OPPOSITE_MOVE(move));
+		}
+		if (count > bufferKeys - 4) {
+			if (runCount == MAX_DEPTH) {
+				fprintf(stderr, "Too many runs, use more memory\n");
+				exit(3);
+			}
+			runs[runCount++] = writeRun(keys, count, temp);
+			count = 0;
+		}
+	}
+	fclose(layer);
+	if (count || !runCount) {
+		runs[runCount++] = writeRun(keys, count, temp);
+	}
+	free(keys);
+	free(temp);
+
+	// merge the runs, leaving out the layer before
+	KeyStream streams[MAX_DEPTH];
+	for (int i = 0; i < runCount; i++) {
+		rewind(runs[i]);
+		streams[i].f = runs[i];
+		advance(&streams[i]);
+	}
+	KeyStream previous = {depth ? openLayer(depth - 1, "rb") : NULL};
+	advance(&previous);
+
+	char temporary[4096];
+	snprintf(temporary, sizeof(temporary), "%s.tmp", layerPath(depth + 1));
+	FILE *out = fopen(temporary, "wb");
+	if (out == NULL) {
+		perror(temporary);
+		exit(5);
+	}
+	long size = 0;
+	bool written = false;
+	uint64_t last = 0;
+	for (;;) {
+		int smallest = -1;
+		for (int i = 0; i < runCount; i++) {
+			if (!streams[i].done && (smallest < 0 || streams[i].key < streams[smallest].key)) {
+				smallest = i;
+			}
+		}
+		if (smallest < 0) {
+			break;
+		}
+		const uint64_t key = streams[smallest].key;
+		advance(&streams[smallest]);
+		if (written && key == last) {
+			continue;
+		}
+		while (!previous.done && previous.key < key) {
+			advance(&previous);
+		}
+		if (!previous.done && previous.key == key) {
+			continue;
+		}
+		fwrite(&key, sizeof(uint64_t), 1, out);
+		last = key;
+		written = true;
+		size++;
+	}
+	for (int i = 0; i < runCount; i++) {
+		fclose(runs[i]);
+	}
+	if (previous.f != NULL) {
+		fclose(previous.f);
+	}
+	fflush(out);
+	fsync(fileno(out));
+	fclose(out);
+	rename(temporary, layerPath(depth + 1));
+	return size;
+}
+
+// returns the depth of the last layer
+int layerSearch() {
+	int depth = 0;
+	int pass = 0;
+	if (!loadProgress(&depth, &pass)) {
+		Board goal;
+		goalBoard(&goal, rows, cols);
+		const uint64_t rank = rankSolvable(&goal);
+		FILE *f = openLayer(0, "wb");
+		fwrite(&rank, sizeof(uint64_t), 1, f);
+		fclose(f);
+		depth = 0;
+		counts[0] = 1;
+		saveProgress(depth, 0);
+	}
+	while (pass != FINISHED) {
+		const long size = nextLayer(depth);
+		if (!size) {
+			unlink(layerPath(depth + 1));
+			saveProgress(depth, pass = FINISHED);
+			// only the last layer is kept, for -o
+			if (depth) {
+				unlink(layerPath(depth - 1));
+			}
+			break;
+		}
+		counts[++depth] = size;
+		saveProgress(depth, 0);
+		// the next layer only needs this one and the one before, so at most 3 are ever on disk
+		if (depth >= 2) {
+			unlink(layerPath(depth - 2));
+		}
+	}
+	if (hardest != NULL) {
+		FILE *f = openLayer(depth, "rb");
+		uint64_t rank;
+		while (fread(&rank, sizeof(uint64_t), 1, f) == 1) {
+			writeHardest(rank);
+		}
+		fclose(f);
+	}
+	return depth;
+}
+
+int main(int argc, char *argv[]) {
+	bool external = false;
+	const char *hardestPath = NULL;
+
+	opterr = 0;
+	int c;
+	while ((c = getopt(argc, argv, "eM:d:o:")) != -1) {
+		switch (c) {
+			case 'e':
+				external = true;
+				break;
+			case 'M':
+				memoryBytes = atol(optarg) << 20;
+				break;
+			case 'd':
+				directory = optarg;
+				break;
+			case 'o':
+				hardestPath = optarg;
+				break;
+			case ':':
+				fprintf(stderr, "Option %c must take value\n", optopt);
+				exit(1);
+			case '?':
+				fprintf(stderr, "Unknown option %c\n", optopt);
+				exit(2);
+		}
+	}
+	if (argc - optind != 2) {
+		usage();
+	}
+	rows = atoi(argv[optind]);
+	cols = atoi(argv[optind + 1]);
+	if (rows < 2 || cols < 2 || rows * cols > MAX_RANK_CELLS || memoryBytes < 1 << 20) {
+		usage();
+	}
+	mkdir(directory, 0755);
+
+	if (hardestPath != NULL) {
+		hardest = fopen(hardestPath, "w");
+		if (hardest == NULL) {
+			perror(hardestPath);
+			exit(5);
+		}
+		const RecordHeader header = {rows, cols, ALGORITHM_NONE};
+		writeTextHeader(hardest, &header);
+	}
+
+	const bool bitmapFits = (solvableCount(rows, cols) + 3) / 4 <= memoryBytes;
+	const int depth = external || !bitmapFits ? layerSearch() : bitmapSearch();
+
+	long total = 0;
+	for (int d = 0; d <= depth; d++) {
+		printf("%i %li\n", d, counts[d]);
+		total += counts[d];
+	}
+	printf("%li boards, at most %i moves from the goal\n", total, depth);
+	if (hardest != NULL) {
+		fclose(hardest);
+	}
+}
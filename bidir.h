@@ -0,0 +1,226 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "astar.h"
+#include "profile.h"
+#include "ranking.h"
+#include "sorted_keys.h"
+
+// bidirectional search that meets in the middle, for boards of up to MAX_RANK_CELLS cells
+//
+// one frontier grows from the scrambled board and one from the goal, a layer at a time,
+// always growing whichever newest layer is smaller. layers are sorted arrays of ranks so
+// removing duplicates and checking whether the frontiers met are both a merge.
+// since every move changes the parity of the permutation, the neighbours of a layer
+// are only ever in the layer before or the layer after, so only the layer before
+// needs to be subtracted.
+//
+// states that can't be on a path of at most bound moves, judging by manhattan distance
+// to the other end, are never added. the first time the frontiers meet is optimal
+// as long as bound is at least the optimal length; bound starts at the manhattan
+// distance of the board and grows by 2 (solution lengths all have the same parity)
+// until they do
+//
+// a limit is checked before each layer is grown, counting every key held and as many as
+// the layer could add, so a limit on nodes stops it before it allocates past it
+
+#define MAX_BIDIR_DEPTH 256
+
+typedef struct KeyLayer {
+	uint64_t *keys;
+	long count;
+} KeyLayer;
+
+typedef struct Frontier {
+	KeyLayer layers[MAX_BIDIR_DEPTH];
+	int depth; // index of the newest layer
+	unsigned char target[MAX_RANK_CELLS]; // where every tile is at the other end
+	long expanded;
+} Frontier;
+
+typedef struct BidirStats {
+	long expanded[2]; // forward, backward
+	int depth[2]; // how deep each frontier was when they met
+	int bound; // final bound
+	int iterations; // number of bounds tried
+	bool stopped; // gave up because of the limit
+} BidirStats;
+
+static void boardFromRank(uint64_t rank, int rows, int cols, Board *board) {
+	board->rows = rows;
+	board->cols = cols;
+	unrankPerm(rank, rows * cols, board->cells);
+	for (board->blank = 0; board->cells[board->blank]; board->blank++);
+}
+
+void startFrontier(Frontier *f, const Board *from, const Board *to) {
+	for (int i = 0; i < to->rows * to->cols; i++) {
+		f->target[to->cells[i]] = i;
+	}
+	f->depth = 0;
+	f->layers[0].keys = malloc(sizeof(uint64_t));
+	f->layers[0].keys[0] = rankPerm(from->cells, from->rows * from->cols);
+	f->layers[0].count = 1;
+}
+
+// keys held in every layer of f
+static long frontierKeys(const Frontier *f) {
+	long keys = 0;
+	for (int i = 0; i <= f->depth; i++) {
+		keys += f->layers[i].count;
+	}
+	return keys;
+}
+
+void freeFrontier(Frontier *f) {
+	for (int i = 0; i <= f->depth; i++) {
+		free(f->layers[i].keys);
+	}
+	f->depth = -1;
+}
+
+// grows the next layer, returns false if it's empty
+bool expandFrontier(Frontier *f, int rows, int cols, int bound) {
+	const KeyLayer *current = &f->layers[f->depth];
+	const int g = f->depth + 1;
+	uint64_t *next = malloc((4 * current->count + 1) * sizeof(uint64_t));
+	long count = 0;
+	Board board;
+	for (long i = 0; i < current->count; i++) {
+		boardFromRank(current->keys[i], rows, cols, &board);
+		const int h = manhattanTo(&board, f->target);
+		for (int move = 0; move < 4; move++) {
+			if (!canMove(&board, move) || g + h + manhattanDelta(&board, f->target, move) > bound) {
+				continue;
+			}
+			applyMove(&board, move);
+			next[count++] = rankPerm(board.cells, rows * cols);
+			applyMove(&board, OPPOSITE_MOVE(move));
+		}
+	}
+	f->expanded += current->count;
+
+	uint64_t *temp = malloc((count + 1) * sizeof(uint64_t));
+	sortKeys(next, count, temp);
+	free(temp);
+	count = uniqueKeys(next, count);
+	if (f->depth) {
+		const KeyLayer *previous = &f->layers[f->depth - 1];
+		count = subtractKeys(next, count, previous->keys, previous->count);
+	}
+	if (!count) {
+		free(next);
+		return false;
+	}
+	f->depth++;
+	f->layers[f->depth].keys = realloc(next, count * sizeof(uint64_t));
+	f->layers[f->depth].count = count;
+	return true;
+}
+
+// walks from the meeting point back to the start of f one layer at a time
+// writes the moves that lead from the meeting point towards the start in to path
+void traceBack(const Frontier *f, uint64_t meeting, int rows, int cols, int *path) {
+	Board board;
+	boardFromRank(meeting, rows, cols, &board);
+	for (int d = f->depth; d > 0; d--) {
+		const KeyLayer *previous = &f->layers[d - 1];
+		for (int move = 0; move < 4; move++) {
+			if (!canMove(&board, move)) {
+				continue;
+			}
+			applyMove(&board, move);
+			if (containsKey(previous->keys, previous->count, rankPerm(board.cells, rows * cols))) {
+				path[f->depth - d] = move;
+				break;
+			}
+			applyMove(&board, OPPOSITE_MOVE(move));
+		}
+	}
+}
+
+// writes an optimal solution in to moves and returns its length
+// returns -1 if the board has too many cells, the solution won't fit in capacity
+// or limit stopped the search
+int solveBidirectional(const Board *start, const SearchLimit *limit, char *moves, int capacity, BidirStats *stats) {
+	const int rows = start->rows;
+	const int cols = start->cols;
+	memset(stats, 0, sizeof(BidirStats));
+	PROFILE_SEARCH(SEARCH_BIDIRECTIONAL);
+	if (rows * cols > MAX_RANK_CELLS) {
+		return -1;
+	}
+	Board goal;
+	goalBoard(&goal, rows, cols);
+
+	for (int bound = manhattan(start); bound < MAX_BIDIR_DEPTH; bound += 2) {
+		stats->bound = bound;
+		stats->iterations++;
+		Frontier *frontiers = malloc(2 * sizeof(Frontier));
+		Frontier *forward = &frontiers[0];
+		Frontier *backward = &frontiers[1];
+		startFrontier(forward, start, &goal);
+		startFrontier(backward, &goal, start);
+		forward->expanded = backward->expanded = 0;
+
+		long meeting = forward->layers[0].keys[0] == backward->layers[0].keys[0] ? 0 : -1;
+		while (meeting < 0 && forward->depth + backward->depth < bound) {
+			const bool growForward = forward->layers[forward->depth].count <= backward->layers[backward->depth].count;
+			Frontier *growing = growForward ? forward : backward;
+			const long held = frontierKeys(forward) + frontierKeys(backward);
+			if (limitReached(limit, held + 4 * growing->layers[growing->depth].count)) {
+				stats->stopped = true;
+				break;
+			}
+			if (!expandFrontier(growing, rows, cols, bound)) {
+				break;
+			}
+			const KeyLayer *f = &forward->layers[forward->depth];
+			const KeyLayer *b = &backward->layers[backward->depth];
+			meeting = firstCommonKey(f->keys, f->count, b->keys, b->count);
+		}
+		stats->expanded[0] += forward->expanded;
+		stats->expanded[1] += backward->expanded;
+		PROFILE_ITERATION(SEARCH_BIDIRECTIONAL, stats->iterations - 1, forward->expanded + backward->expanded);
+
+		int length = -1;
+		if (meeting >= 0) {
+			length = forward->depth + backward->depth;
+			stats->depth[0] = forward->depth;
+			stats->depth[1] = backward->depth;
+			if (length <= capacity) {
+				const uint64_t key = forward->layers[forward->depth].keys[meeting];
+				int path[MAX_BIDIR_DEPTH];
+
+				// the forward moves come out backwards and undoing the moves towards the start
+				traceBack(forward, key, rows, cols, path);
+				for (int i = 0; i < forward->depth; i++) {
+					moves[forward->depth - 1 - i] = moveChars[OPPOSITE_MOVE(path[i])];
+				}
+				traceBack(backward, key, rows, cols, path);
+				for (int i = 0; i < backward->depth; i++) {
+					moves[forward->depth + i] = moveChars[path[i]];
+				}
+			}
+			else {
+				length = -1;
+			}
+		}
+		freeFrontier(forward);
+		freeFrontier(backward);
+		free(frontiers);
+		if (meeting >= 0) {
+			return length;
+		}
+		if (stats->stopped) {
+			return -1;
+		}
+	}
+	return -1;
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "game_vars.h"
+
+// a board that lives off screen
+// the solvers, tools and file formats work on these instead of GameVars
+// so nothing has to be drawn while searching
+//
+// the goal layout is the one init() sets up: cells[i] == i, with the 0 in the top left
+
+#define MAX_CELLS 256
+
+// moves are named after the direction the 0 travels, same as the DOMOVES strings
+// opposite moves differ only in their second bit
+enum {
+	MOVE_UP,
+	MOVE_RIGHT,
+	MOVE_DOWN,
+	MOVE_LEFT
+};
+#define OPPOSITE_MOVE(m) ((m) ^ 2)
+
+const char moveChars[] = "urdl";
+
+typedef struct Board {
+	int rows;
+	int cols;
+	int blank; // index of the 0
+	unsigned char cells[MAX_CELLS];
+} Board;
+
+// returns the move represented by c, or -1 if c isn't one of "urdl"
+int moveFromChar(char c) {
+	switch (c) {
+		case 'u':
+			return MOVE_UP;
+		case 'r':
+			return MOVE_RIGHT;
+		case 'd':
+			return MOVE_DOWN;
+		case 'l':
+			return MOVE_LEFT;
+	}
+	return -1;
+}
+
+void goalBoard(Board *board, int rows, int cols) {
+	board->rows = rows;
+	board->cols = cols;
+	board->blank = 0;
+	for (int i = 0; i < rows * cols; i++) {
+		board->cells[i] = i;
+	}
+}
+
+bool isGoal(const Board *board) {
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		if (board->cells[i] != i) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// where cell is once a rows by cols board is reflected in its main diagonal, making it cols by rows
+static inline int transposeCell(int rows, int cols, int cell) {
+	return cell % cols * rows + cell / cols;
+}
+
+// reflects board in its main diagonal. tiles are renamed the same way cells are, so the goal
+// reflects to the goal and a board is as many moves from it as its reflection is
+void transposeBoard(const Board *board, Board *transposed) {
+	const int rows = board->rows;
+	const int cols = board->cols;
+	transposed->rows = cols;
+	transposed->cols = rows;
+	transposed->blank = transposeCell(rows, cols, board->blank);
+	for (int i = 0; i < rows * cols; i++) {
+		transposed->cells[transposeCell(rows, cols, i)] = transposeCell(rows, cols, board->cells[i]);
+	}
+}
+
+// parity of the permutation of the first length cells, assumes every value appears once
+// up to 64 cells the values seen so far fit in one word, so counting the inversions each cell
+// makes with the cells before it is a shift and a popcount with no branches
+// past that it counts cycles instead: a permutation with c cycles is length - c swaps from sorted
+bool permutationParity(const unsigned char *cells, int length) {
+	if (length <= 64) {
+		uint64_t seen = 0;
+		int inversions = 0;
+		for (int i = 0; i < length; i++) {
+			inversions += __builtin_popcountll(seen >> cells[i]);
+			seen |= 1ull << cells[i];
+		}
+		return inversions & 1;
+	}
+	uint64_t visited[(MAX_CELLS + 63) / 64] = {0};
+	int cycles = 0;
+	for (int i = 0; i < length; i++) {
+		if (visited[i / 64] >> (i % 64) & 1) {
+			continue;
+		}
+		cycles++;
+		for (int j = i; !(visited[j / 64] >> (j % 64) & 1); j = cells[j]) {
+			visited[j / 64] |= 1ull << (j % 64);
+		}
+	}
+	return (length - cycles) & 1;
+}
+
+// whether the goal can be reached from board, assumes every value appears once
+//
+// credit for this goes to Chris Calabro
+// http://cseweb.ucsd.edu/~ccalabro/essays/15_puzzle.pdf
+// every move swaps the 0 with a neighbour, flipping the parity of the permutation and of
+// the manhattan distance of the 0 to its goal position, so solvable boards are the ones
+// where those 2 parities match
+bool isSolvable(const Board *board) {
+	const bool manhattanParity = (board->blank / board->cols + board->blank % board->cols) % 2;
+	return permutationParity(board->cells, board->rows * board->cols) == manhattanParity;
+}
+
+// copy the on screen board
+void boardFromGame(GameVars *game, Board *board) {
+	board->rows = game->rows;
+	board->cols = game->cols;
+	board->blank = game->y * game->cols + game->x;
+	for (int i = 0; i < game->rows * game->cols; i++) {
+		board->cells[i] = game->cells[i];
+	}
+	board->cells[board->blank] = 0; // swap0 doesn't keep the cell under the 0 up to date
+}
+
+bool canMove(const Board *board, int move) {
+	switch (move) {
+		case MOVE_UP:
+			return board->blank >= board->cols;
+		case MOVE_RIGHT:
+			return board->blank % board->cols != board->cols - 1;
+		case MOVE_DOWN:
+			return board->blank < (board->rows - 1) * board->cols;
+		case MOVE_LEFT:
+			return board->blank % board->cols != 0;
+	}
+	return false;
+}
+
+// how far the 0 travels in cells for a move
+static inline int moveOffset(const Board *board, int move) {
+	switch (move) {
+		case MOVE_UP:
+			return -board->cols;
+		case MOVE_RIGHT:
+			return 1;
+		case MOVE_DOWN:
+			return board->cols;
+	}
+	return -1;
+}
+
+// assumes the move is legal
+static inline void applyMove(Board *board, int move) {
+	const int to = board->blank + moveOffset(board, move);
+	board->cells[board->blank] = board->cells[to];
+	board->cells[to] = 0;
+	board->blank = to;
+}
+
+// returns whether the move was legal; the board is only changed if it was
+bool tryMove(Board *board, int move) {
+	if (!canMove(board, move)) {
+		return false;
+	}
+	applyMove(board, move);
+	return true;
+}
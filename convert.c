@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "records.h"
+
+void usage() {
+	fprintf(stderr, "Usage: ./convert (-b | -t) [-r] [-p] input output\n"
+			"-b converts text records to binary, -t converts binary records to text\n"
+			"-r allows run length encoded solutions in the binary output\n"
+			"-p stores boards as permutation ranks in the binary output (up to 20 cells)\n"
+			"input and output may be - for stdin/stdout\n");
+	exit(4);
+}
+
+FILE *openOrStd(const char *path, const char *mode, FILE *std) {
+	if (!strcmp(path, "-")) {
+		return std;
+	}
+	FILE *f = fopen(path, mode);
+	if (f == NULL) {
+		perror(path);
+		exit(5);
+	}
+	return f;
+}
+
+int main(int argc, char *argv[]) {
+	int toBinary = -1;
+	bool runLength = false;
+	bool ranked = false;
+
+	opterr = 0;
+	int c;
+	while ((c = getopt(argc, argv, "btrp")) != -1) {
+		switch (c) {
+			case 'b':
+				toBinary = true;
+				break;
+			case 't':
+				toBinary = false;
+				break;
+			case 'r':
+				runLength = true;
+				break;
+			case 'p':
+				ranked = true;
+				break;
+			case '?':
+				fprintf(stderr, "Unknown option %c\n", optopt);
+				exit(2);
+		}
+	}
+	if (toBinary == -1 || argc - optind != 2) {
+		usage();
+	}
+
+	FILE *in = openOrStd(argv[optind], toBinary ? "r" : "rb", stdin);
+	FILE *out = openOrStd(argv[optind + 1], toBinary ? "wb" : "w", stdout);
+
+	RecordHeader header;
+	if (!(toBinary ? readTextHeader(in, &header) : readRecordHeader(in, &header))) {
+		fprintf(stderr, "Bad header\n");
+		exit(1);
+	}
+	header.flags = runLength ? RECORD_RLE : 0;
+	if (toBinary) {
+		header.encoding = ranked ? BOARD_RANKED : BOARD_PACKED;
+		if (!validEncoding(&header)) {
+			fprintf(stderr, "Boards with more than %i cells can't be stored as ranks\n", MAX_RANK_CELLS);
+			exit(3);
+		}
+	}
+	if (!(toBinary ? writeRecordHeader(out, &header) : writeTextHeader(out, &header))) {
+		perror("write");
+		exit(5);
+	}
+
+	Record record = {0};
+	long count = 0;
+	int status;
+	while ((status = toBinary ? readTextRecord(in, &header, &record) : readRecord(in, &header, &record)) == RECORD_OK) {
+		const bool written = toBinary
+			? writeRecord(out, &header, &record.board, record.moves, record.moveCount)
+			: writeTextRecord(out, &header, &record.board, record.moves, record.moveCount);
+		if (!written) {
+			perror("write");
+			exit(5);
+		}
+		count++;
+	}
+	freeRecord(&record);
+	if (status == RECORD_CORRUPT) {
+		fprintf(stderr, "Bad record after %li records\n", count);
+		exit(1);
+	}
+
+	fclose(in);
+	fclose(out);
+}
@@ -0,0 +1,97 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#include "board.h"
+#include "ranking.h"
+
+// exact distance to the goal for every solvable 3x3 board, found by a breadth first
+// search backwards from the goal over the ranks from rankSolvable
+//
+// one byte per board: the distance in the low 5 bits (no 3x3 board is more than 31
+// moves away) and the move that gets one step closer in the 2 above that,
+// so solving is just following the hints
+
+#define EIGHT_STATES 181440 // 9! / 2
+#define EIGHT_DISTANCE_MASK 0x1f
+#define EIGHT_HINT_SHIFT 5
+#define EIGHT_UNSEEN 0xff
+
+typedef struct EightTable {
+	unsigned char entries[EIGHT_STATES];
+	int maxDistance;
+	long counts[EIGHT_DISTANCE_MASK + 1]; // number of boards at each distance
+} EightTable;
+
+void buildEightTable(EightTable *table) {
+	memset(table->entries, EIGHT_UNSEEN, EIGHT_STATES);
+	memset(table->counts, 0, sizeof(table->counts));
+
+	// every rank is queued exactly once so the queue never wraps
+	uint32_t *queue = malloc(EIGHT_STATES * sizeof(uint32_t));
+	Board board;
+	goalBoard(&board, 3, 3);
+	queue[0] = rankSolvable(&board);
+	table->entries[queue[0]] = 0;
+	int head = 0;
+	int tail = 1;
+	while (head < tail) {
+		const uint32_t rank = queue[head++];
+		const int distance = table->entries[rank] & EIGHT_DISTANCE_MASK;
+		table->counts[distance]++;
+		table->maxDistance = distance;
+
+		unrankSolvable(rank, 3, 3, &board);
+		for (int move = 0; move < 4; move++) {
+			if (!canMove(&board, move)) {
+				continue;
+			}
+			applyMove(&board, move);
+			const uint32_t next = rankSolvable(&board);
+			if (table->entries[next] == EIGHT_UNSEEN) {
+				// undoing the move we got here with is a step towards the goal
+				table->entries[next] = (distance + 1) | OPPOSITE_MOVE(move) << EIGHT_HINT_SHIFT;
+				queue[tail++] = next;
+			}
+			applyMove(&board, OPPOSITE_MOVE(move));
+		}
+	}
+	free(queue);
+}
+
+EightTable *eightTableStore = NULL;
+
+static void makeEightTable() {
+	eightTableStore = malloc(sizeof(EightTable));
+	buildEightTable(eightTableStore);
+}
+
+// the table is only built the first time it's needed, once even if several threads ask at once
+EightTable *eightTable() {
+	static pthread_once_t once = PTHREAD_ONCE_INIT;
+	pthread_once(&once, &makeEightTable);
+	return eightTableStore;
+}
+
+// returns the optimal number of moves, assumes board is a solvable 3x3
+int eightDistance(const Board *board) {
+	return eightTable()->entries[rankSolvable(board)] & EIGHT_DISTANCE_MASK;
+}
+
+// writes an optimal solution in to moves, which must fit at least 31 moves
+// returns the number of moves
+int eightSolve(const Board *board, char *moves) {
+	const EightTable *table = eightTable();
+	Board copy = *board;
+	int length = 0;
+	unsigned char entry;
+	while ((entry = table->entries[rankSolvable(&copy)]) & EIGHT_DISTANCE_MASK) {
+		const int move = entry >> EIGHT_HINT_SHIFT & 3;
+		applyMove(&copy, move);
+		moves[length++] = moveChars[move];
+	}
+	return length;
+}
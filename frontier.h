@@ -0,0 +1,275 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "astar.h"
+
+// breadth first frontier search with divide and conquer solution reconstruction
+// https://www.aaai.org/Papers/JAIR/Vol22/JAIR-2209.pdf
+// http://www.aaai.org/Papers/ICAPS/2004/ICAPS04-011.pdf
+//
+// optimal without a closed list. the search goes a layer (every board at one depth) at a time,
+// only keeping boards with depth + h within a bound, which goes up by 2 until the goal turns up.
+// every move changes the parity of the depth, so a board's neighbours are all in the layer before
+// or after, and each board has a bit per move that leads back to a board in the layer before.
+// those moves aren't made, so only the layer being expanded and the one being made are kept.
+//
+// without a closed list there are no parents to follow back. instead every board past the middle
+// layer remembers which board in the middle layer it came from, the middle layer is kept, and
+// once the goal turns up the solution is the solutions from the start to that board and from it
+// to the goal, found the same way. those searches are to any board, so they estimate with
+// manhattan distance to it rather than the heuristic, which only knows the goal
+
+#define FRONTIER_FOUND_NONE -1
+#define FRONTIER_STOPPED -2
+
+typedef struct FrontierStats {
+	long expanded;
+	long generated;
+	int iterations; // of the outer search, each with a bound 2 higher
+	long peakNodes; // boards held at once
+	bool stopped; // gave up because of the limit
+} FrontierStats;
+
+// one layer, a pool of boards with an open addressed table over it
+typedef struct FrontierLayer {
+	int n; // cells per board
+	int count;
+	int capacity;
+	unsigned char *cells; // n per board
+	unsigned char *used; // per board, moves that lead back a layer
+	int *relays; // per board, which board in the middle layer it came from, -1 if not past it
+	int *slots; // board + 1, 0 is empty
+	uint32_t slotMask;
+} FrontierLayer;
+
+typedef struct FrontierSearch {
+	const Heuristic *heuristic;
+	const SearchLimit *limit;
+	FrontierStats *stats;
+	FrontierLayer layers[2];
+	unsigned char *middle; // cells of the middle layer
+	int middleCapacity;
+	bool toGoal; // whether the target is the goal, so heuristic can be used
+	unsigned char homes[MAX_CELLS]; // of each tile in the target
+} FrontierSearch;
+
+static void clearFrontierLayer(FrontierLayer *layer) {
+	layer->count = 0;
+	memset(layer->slots, 0, (layer->slotMask + 1) * sizeof(int));
+}
+
+static int *findFrontierSlot(FrontierLayer *layer, const unsigned char *cells) {
+	uint32_t i = hashCells(cells, layer->n) & layer->slotMask;
+	while (layer->slots[i] && memcmp(&layer->cells[(layer->slots[i] - 1) * (long)layer->n], cells, layer->n)) {
+		i = (i + 1) & layer->slotMask;
+	}
+	return &layer->slots[i];
+}
+
+// adds cells reached by move if the layer doesn't have them yet
+static void addToFrontier(FrontierLayer *layer, const unsigned char *cells, int move, int relay) {
+	int *slot = findFrontierSlot(layer, cells);
+	if (*slot) {
+		layer->used[*slot - 1] |= 1 << OPPOSITE_MOVE(move);
+		return;
+	}
+	if (layer->count == layer->capacity) {
+		layer->capacity *= 2;
+		layer->cells = realloc(layer->cells, layer->capacity * (long)layer->n);
+		layer->used = realloc(layer->used, layer->capacity);
+		layer->relays = realloc(layer->relays, layer->capacity * sizeof(int));
+	}
+	const int board = layer->count++;
+	memcpy(&layer->cells[board * (long)layer->n], cells, layer->n);
+	layer->used[board] = move < 0 ? 0 : 1 << OPPOSITE_MOVE(move);
+	layer->relays[board] = relay;
+	*slot = board + 1;
+	// keep the table at most half full
+	if (2 * (uint32_t)layer->count > layer->slotMask) {
+		free(layer->slots);
+		layer->slotMask = layer->slotMask * 2 + 1;
+		layer->slots = calloc(layer->slotMask + 1, sizeof(int));
+		for (int i = 0; i < layer->count; i++) {
+			*findFrontierSlot(layer, &layer->cells[i * (long)layer->n]) = i + 1;
+		}
+	}
+}
+
+static int frontierEstimate(const FrontierSearch *f, const Board *board) {
+	if (f->toGoal) {
+		return f->heuristic->estimate(board);
+	}
+	int h = 0;
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		if (board->cells[i]) {
+			const int home = f->homes[board->cells[i]];
+			h += abs(i / board->cols - home / board->cols) + abs(i % board->cols - home % board->cols);
+		}
+	}
+	return h;
+}
+
+// searches layer by layer from start for target, keeping boards with depth + h at most bound
+// returns the depth it was found at, FRONTIER_FOUND_NONE or FRONTIER_STOPPED,
+// and if it was found past middleDepth, sets middle to the board it came through there
+static int frontierLayers(FrontierSearch *f, const Board *start, const Board *target, int bound,
+		int middleDepth, Board *middle) {
+	const int n = start->rows * start->cols;
+	f->toGoal = isGoal(target);
+	for (int i = 0; i < n; i++) {
+		f->homes[target->cells[i]] = i;
+	}
+	FrontierLayer *current = &f->layers[0];
+	FrontierLayer *next = &f->layers[1];
+	clearFrontierLayer(current);
+	addToFrontier(current, start->cells, -1, middleDepth ? -1 : 0);
+	if (!middleDepth) {
+		memcpy(f->middle, start->cells, n);
+	}
+
+	Board board = *start;
+	for (int depth = 0;; depth++) {
+		for (int i = 0; i < current->count; i++) {
+			if (!memcmp(&current->cells[i * (long)n], target->cells, n)) {
+				const int relay = current->relays[i];
+				if (relay >= 0) {
+					*middle = *start;
+					memcpy(middle->cells, &f->middle[relay * (long)n], n);
+					for (middle->blank = 0; middle->cells[middle->blank]; middle->blank++);
+				}
+				return depth;
+			}
+		}
+		if (depth == bound || !current->count) {
+			return FRONTIER_FOUND_NONE;
+		}
+		if (limitReached(f->limit, f->stats->expanded)) {
+			f->stats->stopped = true;
+			return FRONTIER_STOPPED;
+		}
+
+		clearFrontierLayer(next);
+		for (int i = 0; i < current->count; i++) {
+			memcpy(board.cells, &current->cells[i * (long)n], n);
+			for (board.blank = 0; board.cells[board.blank]; board.blank++);
+			f->stats->expanded++;
+			const int used = current->used[i];
+			const int relay = current->relays[i];
+			for (int move = 0; move < 4; move++) {
+				if (used & 1 << move || !canMove(&board, move)) {
+					continue;
+				}
+				applyMove(&board, move);
+				if (depth + 1 + frontierEstimate(f, &board) <= bound) {
+					f->stats->generated++;
+					addToFrontier(next, board.cells, move, depth + 1 == middleDepth ? next->count : relay);
+				}
+				applyMove(&board, OPPOSITE_MOVE(move));
+			}
+		}
+		if (depth + 1 == middleDepth) {
+			if (next->count > f->middleCapacity) {
+				f->middleCapacity = next->count;
+				f->middle = realloc(f->middle, f->middleCapacity * (long)n);
+			}
+			memcpy(f->middle, next->cells, next->count * (long)n);
+		}
+		const long held = current->count + next->count + (depth >= middleDepth ? f->middleCapacity : 0);
+		f->stats->peakNodes = held > f->stats->peakNodes ? held : f->stats->peakNodes;
+
+		FrontierLayer *temp = current;
+		current = next;
+		next = temp;
+	}
+}
+
+// writes the length moves from start to target in to moves, returns false if stopped
+static bool frontierPath(FrontierSearch *f, const Board *start, const Board *target, int length, char *moves) {
+	if (!length) {
+		return true;
+	}
+	if (length == 1) {
+		Board board = *start;
+		for (int move = 0; move < 4; move++) {
+			if (canMove(&board, move)) {
+				applyMove(&board, move);
+				if (!memcmp(board.cells, target->cells, board.rows * board.cols)) {
+					moves[0] = moveChars[move];
+					return true;
+				}
+				applyMove(&board, OPPOSITE_MOVE(move));
+			}
+		}
+		return false;
+	}
+	const int half = length / 2;
+	Board middle;
+	if (frontierLayers(f, start, target, length, half, &middle) != length) {
+		return false;
+	}
+	return frontierPath(f, start, &middle, half, moves)
+		&& frontierPath(f, &middle, target, length - half, moves + half);
+}
+
+// writes an optimal solution in to moves and returns its length, keeping only two layers
+// and the middle one at a time. returns -1 if it won't fit in capacity or if limit stopped the search
+int solveFrontier(const Board *start, const Heuristic *heuristic, const SearchLimit *limit,
+		char *moves, int capacity, FrontierStats *stats) {
+	memset(stats, 0, sizeof(FrontierStats));
+	const int n = start->rows * start->cols;
+	FrontierSearch f = {heuristic, limit, stats};
+	for (int i = 0; i < 2; i++) {
+		FrontierLayer *layer = &f.layers[i];
+		layer->n = n;
+		layer->capacity = 1 << 12;
+		layer->cells = malloc(layer->capacity * (long)n);
+		layer->used = malloc(layer->capacity);
+		layer->relays = malloc(layer->capacity * sizeof(int));
+		layer->slotMask = (1 << 13) - 1;
+		layer->slots = calloc(layer->slotMask + 1, sizeof(int));
+	}
+	f.middleCapacity = 1;
+	f.middle = malloc(n);
+
+	Board goal;
+	goalBoard(&goal, start->rows, start->cols);
+	// every solution has the parity of the 0's distance from home
+	const int h = heuristic->estimate(start);
+	const int parity = (start->blank / start->cols + start->blank % start->cols) & 1;
+	int length = -1;
+	for (int bound = h + ((h ^ parity) & 1);; bound += 2) {
+		stats->iterations++;
+		Board middle;
+		const int found = frontierLayers(&f, start, &goal, bound, bound / 2, &middle);
+		if (found == FRONTIER_STOPPED) {
+			break;
+		}
+		if (found >= 0) {
+			if (found > capacity) {
+				break;
+			}
+			// the middle is only known if it turned up past it
+			const int half = found >= bound / 2 ? bound / 2 : 0;
+			if (half ? frontierPath(&f, start, &middle, half, moves) && frontierPath(&f, &middle, &goal, found - half, moves + half)
+					: frontierPath(&f, start, &goal, found, moves)) {
+				length = found;
+			}
+			break;
+		}
+	}
+
+	for (int i = 0; i < 2; i++) {
+		free(f.layers[i].cells);
+		free(f.layers[i].used);
+		free(f.layers[i].relays);
+		free(f.layers[i].slots);
+	}
+	free(f.middle);
+	return length;
+}
@@ -1,6 +1,17 @@
 #pragma once
 
+#include <setjmp.h>
+
 #include "undo.h"
+
+// moves the ai made while playing off screen
+typedef struct OffscreenMoves {
+	char *moves;
+	int count;
+	int capacity;
+	jmp_buf abort; // jumped to if the ai makes a move off the board or runs out of room
+} OffscreenMoves;
+
 typedef struct GameVars {
 	int *cells;
 	int *yCoords;
@@ -11,6 +22,7 @@ typedef struct GameVars {
 	int x;
 	Move *undo;
 	int* coordinates;
+	OffscreenMoves *offscreen; // when not NULL the ai doesn't draw and records its moves here instead
 } GameVars;
 
 int getV(GameVars *game, int y, int x) {
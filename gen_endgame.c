@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "board.h"
+
+// generates endgame_table.h: optimal moves for the last 2 cells of a column
+//
+// funAiColumn solves a column down to its top 2 cells, then has to get the last cell
+// in to the top right corner and the second last cell under it without disturbing
+// anything already solved. this brute forces that subproblem in the window made of the
+// 3 rightmost unsolved columns and the top 3 rows (2 when that's all there is),
+// in the same coordinates funAiColumn uses:
+//
+// 	0 1 2
+// 	3 4 5
+// 	6 7 X
+//
+// X is the solved cell under the second last cell. every other tile is interchangeable,
+// so a state is just where the last cell, the second last cell and the 0 are.
+// a breadth first search backwards from the goal (last on 2, second last on 5) gives the
+// optimal distance of every state and a move towards the goal from it
+
+#define WINDOW 9
+#define GOAL_LAST 2
+#define GOAL_SECOND_LAST 5
+#define FROZEN 8
+#define UNSEEN -1
+
+int distances[WINDOW][WINDOW][WINDOW];
+char hints[WINDOW][WINDOW][WINDOW];
+
+bool inWindow(int cell, int height) {
+	return cell >= 0 && cell < 3 * height && cell != FROZEN;
+}
+
+// where the 0 ends up after move, or -1 if it would leave the window
+int moveZero(int zero, int move, int height) {
+	int to;
+	switch (move) {
+		case MOVE_UP:
+			to = zero - 3;
+			break;
+		case MOVE_DOWN:
+			to = zero + 3;
+			break;
+		case MOVE_RIGHT:
+			to = zero % 3 == 2 ? -1 : zero + 1;
+			break;
+		default:
+			to = zero % 3 == 0 ? -1 : zero - 1;
+	}
+	return inWindow(to, height) ? to : -1;
+}
+
+typedef struct State {
+	int last;
+	int secondLast;
+	int zero;
+} State;
+
+void search(int height) {
+	memset(distances, UNSEEN, sizeof(distances));
+	State queue[WINDOW * WINDOW * WINDOW];
+	int head = 0;
+	int tail = 0;
+	for (int zero = 0; zero < WINDOW; zero++) {
+		if (inWindow(zero, height) && zero != GOAL_LAST && zero != GOAL_SECOND_LAST) {
+			distances[GOAL_LAST][GOAL_SECOND_LAST][zero] = 0;
+			queue[tail++] = (State){GOAL_LAST, GOAL_SECOND_LAST, zero};
+		}
+	}
+
+	while (head < tail) {
+		const State s = queue[head++];
+		const int distance = distances[s.last][s.secondLast][s.zero];
+		for (int move = 0; move < 4; move++) {
+			State next = s;
+			next.zero = moveZero(s.zero, move, height);
+			if (next.zero < 0) {
+				continue;
+			}
+			if (next.zero == s.last) {
+				next.last = s.zero;
+			}
+			else if (next.zero == s.secondLast) {
+				next.secondLast = s.zero;
+			}
+			if (distances[next.last][next.secondLast][next.zero] == UNSEEN) {
+				distances[next.last][next.secondLast][next.zero] = distance + 1;
+				hints[next.last][next.secondLast][next.zero] = moveChars[OPPOSITE_MOVE(move)];
+				queue[tail++] = next;
+			}
+		}
+	}
+}
+
+// follow the hints from a state to the goal
+void printMoves(int last, int secondLast, int zero, int height) {
+	putchar('"');
+	while (distances[last][secondLast][zero]) {
+		const char hint = hints[last][secondLast][zero];
+		putchar(hint);
+		const int to = moveZero(zero, moveFromChar(hint), height);
+		if (to == last) {
+			last = zero;
+		}
+		else if (to == secondLast) {
+			secondLast = zero;
+		}
+		zero = to;
+	}
+	putchar('"');
+}
+
+int main() {
+	printf("#pragma once\n\n");
+	printf("// generated by gen_endgame.c, do not edit\n");
+	printf("// endgameMoves[height - 2][last][secondLast][zero] is an optimal DOMOVES string that puts\n");
+	printf("// the last cell in the top right corner and the second last under it\n");
+	printf("// cells are numbered row major in the 3x3 window in the top right of the unsolved area\n");
+	printf("// entries are NULL where the layout can't happen\n\n");
+	printf("#define ENDGAME_WINDOW %i\n\n", WINDOW);
+	printf("char *endgameMoves[2][ENDGAME_WINDOW][ENDGAME_WINDOW][ENDGAME_WINDOW] = {\n");
+	int longest = 0;
+	for (int height = 2; height <= 3; height++) {
+		search(height);
+		for (int last = 0; last < WINDOW; last++) {
+			for (int secondLast = 0; secondLast < WINDOW; secondLast++) {
+				for (int zero = 0; zero < WINDOW; zero++) {
+					const int distance = distances[last][secondLast][zero];
+					const bool valid = inWindow(last, height) && inWindow(secondLast, height) && inWindow(zero, height)
+						&& last != secondLast && last != zero && secondLast != zero;
+					if (!valid) {
+						continue;
+					}
+					if (distance == UNSEEN) {
+						fprintf(stderr, "unreachable: height %i last %i second last %i zero %i\n", height, last, secondLast, zero);
+						return 1;
+					}
+					longest = distance > longest ? distance : longest;
+					printf("\t[%i][%i][%i][%i] = ", height - 2, last, secondLast, zero);
+					printMoves(last, secondLast, zero, height);
+					printf(",\n");
+				}
+			}
+		}
+	}
+	printf("};\n\n");
+	printf("#define ENDGAME_LONGEST %i\n", longest);
+}
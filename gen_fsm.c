@@ -0,0 +1,355 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "board.h"
+
+// generates fsm_table.h: an automaton over moves that rejects move sequences a depth first
+// search never needs to try, after Taylor and Korf
+// https://www.aaai.org/Papers/AAAI/1993/AAAI93-115.pdf
+//
+// a sequence is a duplicate of another if they leave every tile in the same place. the 0 is put
+// in the middle of a board big enough that no sequence up to LENGTH moves reaches an edge and
+// every sequence is tried in order of length then "urdl" order, remembering what each one led to.
+// one that ends up where an earlier one did is dropped if the earlier one's 0 never left the
+// rectangle this one's 0 went over, since then the earlier one can be made on any board this one
+// can. the shortest, first in that order, of all the best paths to a board never contains one, so
+// a search that rejects them is still optimal. "ud" is a duplicate of doing nothing, so this
+// covers not undoing the last move too.
+//
+// only sequences with no dropped sequence in them are tried, so the dropped ones are as short
+// as they can be, and they become an Aho-Corasick automaton. its state is the longest end
+// of the moves so far that starts a dropped sequence, and moving on to one is rejected
+
+#define LENGTH 12 // longest duplicate looked for
+#define SIDE (2 * LENGTH + 1)
+#define CENTER (LENGTH * SIDE + LENGTH)
+#define PRUNED -1
+
+typedef struct Key {
+	uint64_t a;
+	uint64_t b;
+} Key;
+
+// the rectangle the 0 went over, relative to where it started
+typedef struct Box {
+	signed char top;
+	signed char bottom;
+	signed char left;
+	signed char right;
+} Box;
+
+typedef struct Seen {
+	Key key;
+	Box box;
+	bool used;
+} Seen;
+
+// a move sequence, 2 bits per move with the first in the low bits
+typedef struct Word {
+	uint64_t moves;
+	int length;
+} Word;
+
+// every sequence kept, by what it led to. a board can be reached by several
+Seen *seen;
+uint64_t seenMask = (1 << 16) - 1;
+long seenCount;
+
+// dropped sequences, in the order they were found, with an open addressed set over them
+Word *dropped;
+long droppedCount;
+long droppedCapacity = 1 << 10;
+long *droppedSlots; // index + 1, 0 is empty
+uint64_t droppedMask;
+
+static inline uint64_t mix(uint64_t x) {
+	x = (x ^ x >> 30) * 0xbf58476d1ce4e5b9;
+	x = (x ^ x >> 27) * 0x94d049bb133111eb;
+	return x ^ x >> 31;
+}
+
+static inline uint64_t wordHash(Word w) {
+	return mix(w.moves * 64 + w.length);
+}
+
+// adds tile being on cell to a board's key, or takes it off again
+static inline void toggle(Key *key, int cell, int tile) {
+	const uint64_t x = (uint64_t)cell * SIDE * SIDE + tile;
+	key->a ^= mix(x);
+	key->b ^= mix(x + 0x9e3779b97f4a7c15);
+}
+
+static inline bool within(Box inner, Box outer) {
+	return inner.top >= outer.top && inner.bottom <= outer.bottom
+		&& inner.left >= outer.left && inner.right <= outer.right;
+}
+
+bool isDropped(Word w) {
+	for (uint64_t i = wordHash(w) & droppedMask; droppedSlots[i]; i = (i + 1) & droppedMask) {
+		const Word *d = &dropped[droppedSlots[i] - 1];
+		if (d->moves == w.moves && d->length == w.length) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void slotDropped(long index) {
+	uint64_t i = wordHash(dropped[index]) & droppedMask;
+	while (droppedSlots[i]) {
+		i = (i + 1) & droppedMask;
+	}
+	droppedSlots[i] = index + 1;
+}
+
+void addDropped(Word w) {
+	if (droppedCount == droppedCapacity) {
+		droppedCapacity *= 2;
+		dropped = realloc(dropped, droppedCapacity * sizeof(Word));
+		free(droppedSlots);
+		droppedMask = 2 * droppedCapacity - 1;
+		droppedSlots = calloc(droppedMask + 1, sizeof(long));
+		for (long i = 0; i < droppedCount; i++) {
+			slotDropped(i);
+		}
+	}
+	dropped[droppedCount] = w;
+	slotDropped(droppedCount++);
+}
+
+// whether an earlier sequence that led to key stayed inside box
+bool earlierWithin(Key key, Box box) {
+	for (uint64_t i = key.a & seenMask; seen[i].used; i = (i + 1) & seenMask) {
+		if (seen[i].key.a == key.a && seen[i].key.b == key.b && within(seen[i].box, box)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void addSeen(Key key, Box box) {
+	if (2 * (uint64_t)++seenCount > seenMask) {
+		const Seen *old = seen;
+		const uint64_t oldMask = seenMask;
+		seenMask = seenMask * 2 + 1;
+		seen = calloc(seenMask + 1, sizeof(Seen));
+		seenCount = 1;
+		for (uint64_t i = 0; old != NULL && i <= oldMask; i++) {
+			if (old[i].used) {
+				addSeen(old[i].key, old[i].box);
+			}
+		}
+		free((void *)old);
+	}
+	uint64_t i = key.a & seenMask;
+	while (seen[i].used) {
+		i = (i + 1) & seenMask;
+	}
+	seen[i] = (Seen){key, box, true};
+}
+
+// plays w from the middle of an empty board, giving what it led to and where the 0 went
+void play(Word w, Key *key, Box *box) {
+	static int cells[SIDE * SIDE];
+	static Key start;
+	static bool ready = false;
+	if (!ready) {
+		for (int i = 0; i < SIDE * SIDE; i++) {
+			cells[i] = i == CENTER ? 0 : i + (i < CENTER);
+			toggle(&start, i, cells[i]);
+		}
+		ready = true;
+	}
+	*key = start;
+	*box = (Box){0, 0, 0, 0};
+	int blank = CENTER;
+	int row = 0;
+	int col = 0;
+	const int offsets[4] = {-SIDE, 1, SIDE, -1};
+	int visited[LENGTH];
+	for (int i = 0; i < w.length; i++) {
+		const int move = w.moves >> 2 * i & 3;
+		const int to = blank + offsets[move];
+		const int tile = cells[to];
+		toggle(key, to, tile);
+		toggle(key, blank, 0);
+		toggle(key, blank, tile);
+		toggle(key, to, 0);
+		cells[blank] = tile;
+		cells[to] = 0;
+		visited[i] = blank;
+		blank = to;
+		row += move == MOVE_DOWN ? 1 : move == MOVE_UP ? -1 : 0;
+		col += move == MOVE_RIGHT ? 1 : move == MOVE_LEFT ? -1 : 0;
+		box->top = row < box->top ? row : box->top;
+		box->bottom = row > box->bottom ? row : box->bottom;
+		box->left = col < box->left ? col : box->left;
+		box->right = col > box->right ? col : box->right;
+	}
+	// put the board back by moving the 0 back along the way it came
+	for (int i = w.length - 1; i >= 0; i--) {
+		cells[blank] = cells[visited[i]];
+		cells[visited[i]] = 0;
+		blank = visited[i];
+	}
+}
+
+// whether any end of w shorter than it has been dropped. everything in the rest of w was
+// checked when it was kept
+bool endDropped(Word w) {
+	for (int length = 2; length < w.length; length++) {
+		const int skip = w.length - length;
+		if (isDropped((Word){w.moves >> 2 * skip, length})) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// breadth first over sequences, fills dropped
+void findDropped() {
+	droppedMask = 2 * droppedCapacity - 1;
+	dropped = malloc(droppedCapacity * sizeof(Word));
+	droppedSlots = calloc(droppedMask + 1, sizeof(long));
+	seen = calloc(seenMask + 1, sizeof(Seen));
+
+	long count = 1;
+	Word *layer = calloc(1, sizeof(Word));
+	Key key;
+	Box box;
+	play(layer[0], &key, &box);
+	addSeen(key, box);
+	for (int length = 1; length <= LENGTH; length++) {
+		Word *next = malloc(4 * count * sizeof(Word));
+		long nextCount = 0;
+		for (long i = 0; i < count; i++) {
+			for (int move = 0; move < 4; move++) {
+				const Word w = {layer[i].moves | (uint64_t)move << 2 * (length - 1), length};
+				if (endDropped(w)) {
+					continue;
+				}
+				play(w, &key, &box);
+				if (earlierWithin(key, box)) {
+					addDropped(w);
+				}
+				else {
+					addSeen(key, box);
+					next[nextCount++] = w;
+				}
+			}
+		}
+		free(layer);
+		layer = next;
+		count = nextCount;
+	}
+	free(layer);
+}
+
+// the automaton over dropped, numbered in breadth first order with the dropped states left out
+int buildAutomaton(int (**table)[4]) {
+	long capacity = 1;
+	for (long w = 0; w < droppedCount; w++) {
+		capacity += dropped[w].length;
+	}
+	int (*children)[4] = malloc(capacity * sizeof(*children));
+	bool *rejects = calloc(capacity, sizeof(bool));
+	int nodes = 1;
+	memset(children[0], -1, sizeof(children[0]));
+	for (long w = 0; w < droppedCount; w++) {
+		int node = 0;
+		for (int i = 0; i < dropped[w].length; i++) {
+			const int move = dropped[w].moves >> 2 * i & 3;
+			if (children[node][move] < 0) {
+				memset(children[nodes], -1, sizeof(children[nodes]));
+				children[node][move] = nodes++;
+			}
+			node = children[node][move];
+		}
+		rejects[node] = true;
+	}
+
+	// breadth first, every missing child becomes where the longest end that's in the trie goes
+	int *fail = calloc(nodes, sizeof(int));
+	int *queue = malloc(nodes * sizeof(int));
+	int head = 0;
+	int tail = 0;
+	for (int move = 0; move < 4; move++) {
+		if (children[0][move] < 0) {
+			children[0][move] = 0;
+		}
+		else {
+			queue[tail++] = children[0][move];
+		}
+	}
+	while (head < tail) {
+		const int node = queue[head++];
+		rejects[node] |= rejects[fail[node]];
+		for (int move = 0; move < 4; move++) {
+			const int child = children[node][move];
+			if (child < 0) {
+				children[node][move] = children[fail[node]][move];
+			}
+			else {
+				fail[child] = children[fail[node]][move];
+				queue[tail++] = child;
+			}
+		}
+	}
+
+	// renumber what can be reached without being rejected
+	int *numbers = malloc(nodes * sizeof(int));
+	memset(numbers, -1, nodes * sizeof(int));
+	int states = 0;
+	head = tail = 0;
+	queue[tail++] = 0;
+	numbers[0] = states++;
+	while (head < tail) {
+		const int node = queue[head++];
+		for (int move = 0; move < 4; move++) {
+			const int child = children[node][move];
+			if (!rejects[child] && numbers[child] < 0) {
+				numbers[child] = states++;
+				queue[tail++] = child;
+			}
+		}
+	}
+	*table = malloc(states * sizeof(**table));
+	for (int i = 0; i < tail; i++) {
+		const int node = queue[i];
+		for (int move = 0; move < 4; move++) {
+			const int child = children[node][move];
+			(*table)[numbers[node]][move] = rejects[child] ? PRUNED : numbers[child];
+		}
+	}
+	free(children);
+	free(rejects);
+	free(fail);
+	free(queue);
+	free(numbers);
+	return states;
+}
+
+int main() {
+	findDropped();
+	int (*table)[4];
+	const int states = buildAutomaton(&table);
+
+	printf("#pragma once\n\n");
+	printf("// generated by gen_fsm.c, do not edit\n");
+	printf("// fsmTable[state][move] is the state after move, or FSM_PRUNED if the moves so far end\n");
+	printf("// in a sequence that's a duplicate of an earlier one (see gen_fsm.c)\n");
+	printf("// searches start in state 0\n");
+	printf("// %li duplicate sequences of up to %i moves\n\n", droppedCount, LENGTH);
+	printf("#define FSM_PRUNED %i\n", PRUNED);
+	printf("#define FSM_STATES %i\n\n", states);
+	printf("const int fsmTable[FSM_STATES][4] = {\n");
+	for (int s = 0; s < states; s++) {
+		printf("\t{%i, %i, %i, %i}%s\n", table[s][0], table[s][1], table[s][2], table[s][3], s + 1 < states ? "," : "");
+	}
+	printf("};\n");
+	free(table);
+	return 0;
+}
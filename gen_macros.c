@@ -0,0 +1,164 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "board.h"
+
+// generates macro_table.h: optimal moves for getting a cell to its goal position
+// while a column is being solved
+//
+// moveAToB strings together hand made maneuvers (DO360, upRight, shiftRightU, ...)
+// to get cell A to B without touching the cells already solved under B.
+// this brute forces the same subproblem in a window around B, in the coordinates
+// funAiColumn uses. B is on the right edge of the window, with up to 3 rows above it,
+// up to 3 columns to its left and, if there are unsolved rows below, 1 row below:
+//
+// 	. . . .
+// 	. . . .
+// 	. . . .
+// 	. . . B
+// 	. . . X
+//
+// X is the solved cell under B. every other cell is interchangeable so a state is
+// just where A and the 0 are. a breadth first search backwards from A being on B gives
+// the optimal distance of every state and a move towards the goal from it
+
+#define MAX_LEFT 3
+#define MAX_UP 3
+#define WIDTH (MAX_LEFT + 1)
+#define HEIGHT (MAX_UP + 2)
+#define WINDOW (WIDTH * HEIGHT)
+#define UNSEEN -1
+
+// the shape of the window, clipped by the edges of the unsolved area
+typedef struct Shape {
+	int left; // columns left of B
+	int up; // rows above B
+	int down; // rows below B, 0 or 1
+} Shape;
+
+int distances[WINDOW][WINDOW];
+char hints[WINDOW][WINDOW];
+
+int goalCell(const Shape *shape) {
+	return shape->up * WIDTH + shape->left;
+}
+
+bool inWindow(int cell, const Shape *shape) {
+	if (cell < 0 || cell >= WINDOW) {
+		return false;
+	}
+	const int y = cell / WIDTH;
+	const int x = cell % WIDTH;
+	const bool frozen = y == shape->up + 1 && x == shape->left;
+	return x <= shape->left && y <= shape->up + shape->down && !frozen;
+}
+
+// where the 0 ends up after move, or -1 if it would leave the window
+int moveZero(int zero, int move, const Shape *shape) {
+	int to;
+	switch (move) {
+		case MOVE_UP:
+			to = zero - WIDTH;
+			break;
+		case MOVE_DOWN:
+			to = zero + WIDTH;
+			break;
+		case MOVE_RIGHT:
+			to = zero % WIDTH == WIDTH - 1 ? -1 : zero + 1;
+			break;
+		default:
+			to = zero % WIDTH == 0 ? -1 : zero - 1;
+	}
+	return inWindow(to, shape) ? to : -1;
+}
+
+void search(const Shape *shape) {
+	memset(distances, UNSEEN, sizeof(distances));
+	int queue[WINDOW * WINDOW][2];
+	int head = 0;
+	int tail = 0;
+	const int goal = goalCell(shape);
+	for (int zero = 0; zero < WINDOW; zero++) {
+		if (inWindow(zero, shape) && zero != goal) {
+			distances[goal][zero] = 0;
+			queue[tail][0] = goal;
+			queue[tail++][1] = zero;
+		}
+	}
+
+	while (head < tail) {
+		const int a = queue[head][0];
+		const int zero = queue[head++][1];
+		for (int move = 0; move < 4; move++) {
+			const int nextZero = moveZero(zero, move, shape);
+			if (nextZero < 0) {
+				continue;
+			}
+			const int nextA = nextZero == a ? zero : a;
+			if (distances[nextA][nextZero] == UNSEEN) {
+				distances[nextA][nextZero] = distances[a][zero] + 1;
+				hints[nextA][nextZero] = moveChars[OPPOSITE_MOVE(move)];
+				queue[tail][0] = nextA;
+				queue[tail++][1] = nextZero;
+			}
+		}
+	}
+}
+
+// follow the hints from a state to the goal
+void printMoves(int a, int zero, const Shape *shape) {
+	putchar('"');
+	while (distances[a][zero]) {
+		const char hint = hints[a][zero];
+		putchar(hint);
+		const int to = moveZero(zero, moveFromChar(hint), shape);
+		if (to == a) {
+			a = zero;
+		}
+		zero = to;
+	}
+	putchar('"');
+}
+
+int main() {
+	printf("#pragma once\n\n");
+	printf("// generated by gen_macros.c, do not edit\n");
+	printf("// macroMoves[left - 2][up - 2][down][a][zero] is an optimal DOMOVES string that moves\n");
+	printf("// A on to B without touching the solved cell below B\n");
+	printf("// cells are numbered row major in a %ix%i window whose top left is\n", HEIGHT, WIDTH);
+	printf("// up rows above and left columns left of B\n");
+	printf("// entries are NULL where the layout can't happen\n\n");
+	printf("#define MACRO_MAX_LEFT %i\n", MAX_LEFT);
+	printf("#define MACRO_MAX_UP %i\n", MAX_UP);
+	printf("#define MACRO_WIDTH %i\n", WIDTH);
+	printf("#define MACRO_WINDOW %i\n\n", WINDOW);
+	printf("char *macroMoves[MACRO_MAX_LEFT - 1][MACRO_MAX_UP - 1][2][MACRO_WINDOW][MACRO_WINDOW] = {\n");
+	int longest = 0;
+	Shape shape;
+	for (shape.left = 2; shape.left <= MAX_LEFT; shape.left++) {
+		for (shape.up = 2; shape.up <= MAX_UP; shape.up++) {
+			for (shape.down = 0; shape.down <= 1; shape.down++) {
+				search(&shape);
+				for (int a = 0; a < WINDOW; a++) {
+					for (int zero = 0; zero < WINDOW; zero++) {
+						if (!inWindow(a, &shape) || !inWindow(zero, &shape) || a == zero) {
+							continue;
+						}
+						if (distances[a][zero] == UNSEEN) {
+							fprintf(stderr, "unreachable: left %i up %i down %i a %i zero %i\n", shape.left, shape.up, shape.down, a, zero);
+							return 1;
+						}
+						longest = distances[a][zero] > longest ? distances[a][zero] : longest;
+						printf("\t[%i][%i][%i][%i][%i] = ", shape.left - 2, shape.up - 2, shape.down, a, zero);
+						printMoves(a, zero, &shape);
+						printf(",\n");
+					}
+				}
+			}
+		}
+	}
+	printf("};\n\n");
+	printf("#define MACRO_LONGEST %i\n", longest);
+}
@@ -0,0 +1,296 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "records.h"
+#include "ranking.h"
+#include "eight_table.h"
+#include "astar.h"
+#include "anytime.h"
+#include "random_board.h"
+
+// makes instances for load testing the solvers: random walks from the goal, or with -u
+// uniformly random solvable boards, kept only if they're in the difficulty band asked for
+//
+// -d keeps boards whose optimal solution is exactly that many moves. the walk is that long
+// and never revisits a board, so the optimal solution is at most that long, and it's at
+// least that long if A* can't find anything shorter (or the 3x3 table says so)
+// --min-h and --max-h keep boards whose heuristic estimate is in a range
+//
+// several threads generate at once. duplicates are dropped with a shared lock free hash set,
+// keyed by rank for boards that can be ranked and by a 64 bit hash of the cells otherwise
+
+#define MAX_THREADS 256
+#define EXACT_MAX_NODES (1 << 21) // boards A* may keep when checking a distance
+#define MAX_ATTEMPTS_PER_BOARD 100000
+
+int rows;
+int cols;
+long wanted = 100;
+int depth = -1;
+int minH = 0;
+int maxH = 1 << 30;
+int walkLength = -1;
+const Heuristic *heuristic = &heuristics[1];
+long seed;
+bool uniform = false;
+
+Board *boards;
+volatile long found = 0;
+volatile long attempts = 0;
+uint64_t *seen; // keys + 1, 0 is empty
+uint64_t seenMask;
+
+void usage() {
+	fprintf(stderr, "Usage: ./generate [-n count] [-d depth] [--min-h h] [--max-h h] [-h heuristic] [-l walk length]\n"
+			"		[-u] [-j threads] [-s seed] [-b] rows cols [output]\n"
+			"-n sets how many boards to make (default 100)\n"
+			"-d keeps only boards exactly depth moves from the goal\n"
+			"--min-h and --max-h keep only boards the heuristic puts in that range\n"
+			"-h picks the heuristic: manhattan, conflict (default), pdb, walking or packed\n"
+			"-l sets how long the random walks are (default depth, or 100 moves per cell)\n"
+			"-u makes uniformly random solvable boards instead of random walks, can't be used with -d\n"
+			"-j sets the number of threads (default 1 per cpu)\n"
+			"-b writes binary records instead of text\n");
+	exit(4);
+}
+
+// walks from the goal without ever undoing the last move
+// in exact mode it also never comes back to a board, restarting if it gets stuck
+void randomWalk(Board *board, int length, bool exact, uint64_t *random) {
+	PathIndex path = {0};
+	char moves[length > 0 ? length : 1];
+	int made = 0;
+	goalBoard(board, rows, cols);
+	int last = -1;
+	for (int stuck = 0; made < length;) {
+		const int move = nextRandom(random) % 4;
+		if (move == OPPOSITE_MOVE(last) || !canMove(board, move)) {
+			continue;
+		}
+		if (exact) {
+			// checking the whole walk so far every move is fine for walks this short
+			applyMove(board, move);
+			Board start;
+			goalBoard(&start, rows, cols);
+			moves[made] = moveChars[move];
+			indexPath(&path, &start, moves, made);
+			const bool revisit = findOnPath(&path, board, boardKey(board)) >= 0;
+			applyMove(board, OPPOSITE_MOVE(move));
+			if (revisit) {
+				if (++stuck == 16) {
+					goalBoard(board, rows, cols);
+					made = 0;
+					last = -1;
+					stuck = 0;
+				}
+				continue;
+			}
+		}
+		applyMove(board, move);
+		moves[made++] = moveChars[move];
+		last = move;
+	}
+	freePath(&path);
+}
+
+// whether nothing shorter than depth solves board
+bool atLeastDepth(const Board *board) {
+	if (rows == 3 && cols == 3) {
+		return eightDistance(board) >= depth;
+	}
+	const SearchLimit limit = {0, NULL, EXACT_MAX_NODES, depth};
+	char moves[depth > 0 ? depth : 1];
+	AStarStats stats;
+	return solveWeighted(board, &heuristics[1], 1, &limit, moves, depth, &stats) < 0 && !stats.stopped;
+}
+
+uint64_t dedupeKey(const Board *board) {
+	if (rows * cols <= MAX_RANK_CELLS) {
+		return rankPerm(board->cells, rows * cols);
+	}
+	return boardKey(board);
+}
+
+// returns whether key wasn't in the set already
+bool addSeen(uint64_t key) {
+	key++;
+	uint64_t i = (key * 0x9e3779b97f4a7c15) >> 7 & seenMask;
+	for (;;) {
+		uint64_t current = __atomic_load_n(&seen[i], __ATOMIC_RELAXED);
+		if (current == key) {
+			return false;
+		}
+		if (!current) {
+			if (__atomic_compare_exchange_n(&seen[i], &current, key, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+				return true;
+			}
+			if (current == key) {
+				return false;
+			}
+		}
+		i = (i + 1) & seenMask;
+	}
+}
+
+void *generateBoards(void *arg) {
+	uint64_t random = (uint64_t)seed * 0x9e3779b97f4a7c15 + (uintptr_t)arg * 0xbf58476d1ce4e5b9 + 1;
+	Board batch[RANDOM_BATCH];
+	int next = RANDOM_BATCH;
+	while (__atomic_load_n(&found, __ATOMIC_RELAXED) < wanted
+			&& __atomic_add_fetch(&attempts, 1, __ATOMIC_RELAXED) <= wanted * MAX_ATTEMPTS_PER_BOARD) {
+		Board board;
+		if (uniform) {
+			if (next == RANDOM_BATCH) {
+				randomSolvableBoards(&random, rows, cols, batch, RANDOM_BATCH);
+				next = 0;
+			}
+			board = batch[next++];
+		}
+		else {
+			randomWalk(&board, walkLength, depth >= 0, &random);
+		}
+		const int h = heuristic->estimate(&board);
+		if (h < minH || h > maxH || (depth >= 0 && !atLeastDepth(&board)) || !addSeen(dedupeKey(&board))) {
+			continue;
+		}
+		const long index = __atomic_fetch_add(&found, 1, __ATOMIC_RELAXED);
+		if (index < wanted) {
+			boards[index] = board;
+		}
+	}
+	return NULL;
+}
+
+int main(int argc, char *argv[]) {
+	int threads = sysconf(_SC_NPROCESSORS_ONLN);
+	bool binary = false;
+	seed = time(0);
+
+	const struct option longOptions[] = {
+		{"min-h", required_argument, NULL, 'm'},
+		{"max-h", required_argument, NULL, 'M'},
+		{0}
+	};
+	opterr = 0;
+	int c;
+	while ((c = getopt_long(argc, argv, "n:d:h:l:uj:s:b", longOptions, NULL)) != -1) {
+		switch (c) {
+			case 'n':
+				wanted = atol(optarg);
+				break;
+			case 'd':
+				depth = atoi(optarg);
+				break;
+			case 'm':
+				minH = atoi(optarg);
+				break;
+			case 'M':
+				maxH = atoi(optarg);
+				break;
+			case 'h':
+				heuristic = heuristicFromName(optarg);
+				if (heuristic == NULL) {
+					usage();
+				}
+				break;
+			case 'l':
+				walkLength = atoi(optarg);
+				break;
+			case 'u':
+				uniform = true;
+				break;
+			case 'j':
+				threads = atoi(optarg);
+				break;
+			case 's':
+				seed = atol(optarg);
+				break;
+			case 'b':
+				binary = true;
+				break;
+			case ':':
+				fprintf(stderr, "Option %c must take value\n", optopt);
+				exit(1);
+			case '?':
+				fprintf(stderr, "Unknown option %s\n", argv[optind - 1]);
+				exit(2);
+		}
+	}
+	if (argc - optind < 2 || argc - optind > 3) {
+		usage();
+	}
+	rows = atoi(argv[optind]);
+	cols = atoi(argv[optind + 1]);
+	if (rows < 2 || cols < 2 || rows * cols > MAX_CELLS || wanted < 1) {
+		usage();
+	}
+	threads = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+	if (walkLength < 0) {
+		walkLength = depth >= 0 ? depth : 100 * rows * cols;
+	}
+	if (depth >= 0 && uniform) {
+		fprintf(stderr, "-d needs random walks\n");
+		exit(1);
+	}
+	if (depth >= 0 && walkLength != depth) {
+		fprintf(stderr, "The walk length has to be the depth\n");
+		exit(1);
+	}
+
+	FILE *out = stdout;
+	if (argc - optind == 3 && strcmp(argv[optind + 2], "-")) {
+		out = fopen(argv[optind + 2], binary ? "wb" : "w");
+		if (out == NULL) {
+			perror(argv[optind + 2]);
+			exit(5);
+		}
+	}
+
+	// build any tables up front so the threads only ever read them
+	Board goal;
+	goalBoard(&goal, rows, cols);
+	heuristic->estimate(&goal);
+	if (depth >= 0 && rows == 3 && cols == 3) {
+		eightTable();
+	}
+
+	boards = malloc(wanted * sizeof(Board));
+	// every thread can add one more board after found reaches wanted
+	seenMask = 1;
+	while (seenMask < 4 * (wanted + threads)) {
+		seenMask = seenMask * 2 + 1;
+	}
+	seen = calloc(seenMask + 1, sizeof(uint64_t));
+	pthread_t workers[MAX_THREADS];
+	for (long i = 0; i < threads; i++) {
+		pthread_create(&workers[i], NULL, &generateBoards, (void *)i);
+	}
+	for (int i = 0; i < threads; i++) {
+		pthread_join(workers[i], NULL);
+	}
+	const long count = found < wanted ? found : wanted;
+	if (count < wanted) {
+		fprintf(stderr, "Only found %li boards in %li attempts\n", count, attempts);
+	}
+
+	const RecordHeader header = {rows, cols, ALGORITHM_NONE, BOARD_PACKED, 0, seed};
+	bool written = binary ? writeRecordHeader(out, &header) : writeTextHeader(out, &header);
+	for (long i = 0; i < count && written; i++) {
+		written = binary ? writeRecord(out, &header, &boards[i], NULL, 0) : writeTextRecord(out, &header, &boards[i], NULL, 0);
+	}
+	if (!written) {
+		perror("write");
+		exit(5);
+	}
+	fclose(out);
+	free(boards);
+	free(seen);
+}
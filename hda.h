@@ -0,0 +1,467 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "astar.h"
+
+// hash distributed A* (HDA*)
+// http://www.aaai.org/ocs/index.php/ICAPS/ICAPS09/paper/view/691
+//
+// every board belongs to the thread its hash picks, and only that thread ever looks it up,
+// keeps it, or expands it, so each thread has its own pool, table and open list from astar.h
+// with no locking. a child that belongs to another thread is sent to it: messages are
+// collected per owner and handed over HDA_BATCH at a time by pushing the batch on to the
+// owner's inbox, a lock free stack the owner empties in one exchange
+//
+// threads only expand boards in the lowest f layer there is anywhere, so one that gets ahead
+// (or gets more time on a busy machine) waits rather than expanding boards A* never would.
+// a board can be in an open list, in a batch its sender hasn't sent yet, or in an inbox: each
+// thread publishes the lowest f of its open list and unsent batches as its layer, and boards
+// on their way are counted per f in inflight. the sender computes the child's h for that, and
+// the owner uses it rather than working it out again. a send counts its boards in inflight
+// before they can leave the sender's layer, and a receive lowers the owner's layer before it
+// takes them off, so reading the layers, then inflight, then the layers again can't miss any
+// within a layer a thread also yields to one with a deeper board, as serial A* breaks ties
+// towards deeper boards, which finds the goal early in the last layer
+//
+// a thread with nothing left under the best solution so far is idle. termination is one
+// counter of messages not yet settled: the start board counts as one, a send adds one before
+// the message is pushed, and a thread only takes off what it received once it's gone idle,
+// after counting everything those messages led it to send. a thread can only be busy while
+// it holds messages it hasn't settled, so when the counter hits 0 every thread is idle and
+// nothing is on its way, and the best solution found is optimal
+
+#define HDA_MAX_THREADS 64
+#define HDA_MAX_CELLS 32 // bigger boards won't fit in memory anyway
+#define HDA_BATCH 64
+#define HDA_FLUSH_EVERY 64 // expansions between sending off partly filled batches
+#define HDA_MAX_F 256 // boards on their way with a higher f are counted as this - 1
+
+typedef struct HdaStats {
+	long expanded;
+	long generated;
+	long messages; // children sent to another thread
+	long maxExpanded; // by the busiest thread, expanded / threads is perfect balance
+	bool stopped;
+} HdaStats;
+
+typedef struct HdaMessage {
+	unsigned char cells[HDA_MAX_CELLS];
+	int parent;
+	unsigned char parentOwner;
+	char move;
+	int g;
+	int h;
+} HdaMessage;
+
+typedef struct HdaBatch {
+	struct HdaBatch *next;
+	int count;
+	HdaMessage messages[HDA_BATCH];
+} HdaBatch;
+
+typedef struct HdaThread {
+	struct HdaShared *shared;
+	int id;
+	AStarSearch search;
+	unsigned char *parentOwners; // per node, which thread its parent belongs to
+	HdaBatch *inbox; // pushed to by every other thread
+	HdaBatch *outboxes[HDA_MAX_THREADS];
+	int outboxF; // no board in the outboxes has a lower f
+	int layer; // lowest f in the open list and outboxes, INT32_MAX when idle
+	int depth; // g of the best board in the open list
+	long expanded;
+	long generated;
+	long messages;
+} HdaThread;
+
+typedef struct HdaShared {
+	const Board *start;
+	const Heuristic *heuristic;
+	const SearchLimit *limit;
+	int threads;
+	HdaThread *workers;
+	long unsettled;
+	int inflight[HDA_MAX_F]; // boards sent but not yet in their owner's open list, by f
+	volatile bool stop;
+	pthread_mutex_t goalLock;
+	int best; // length of the best solution so far, INT32_MAX for none
+	int goalOwner;
+	int goalNode;
+} HdaShared;
+
+static inline int hdaOwner(const unsigned char *cells, int n, int threads) {
+	// the low bits pick the slot in the owner's table, so use the high ones here
+	return (hashCells(cells, n) >> 32) % threads;
+}
+
+static inline int hdaF(const HdaMessage *m) {
+	return m->g + m->h < HDA_MAX_F ? m->g + m->h : HDA_MAX_F - 1;
+}
+
+// adds change to inflight for every board in batch, a run of the same f at a time
+static void hdaCountInflight(HdaShared *shared, const HdaBatch *batch, int change) {
+	for (int i = 0, run = 1; i < batch->count; i++, run++) {
+		const int f = hdaF(&batch->messages[i]);
+		if (i + 1 == batch->count || hdaF(&batch->messages[i + 1]) != f) {
+			__atomic_add_fetch(&shared->inflight[f], change * run, __ATOMIC_SEQ_CST);
+			run = 0;
+		}
+	}
+}
+
+static void hdaSend(HdaThread *t, int owner) {
+	HdaBatch *batch = t->outboxes[owner];
+	t->outboxes[owner] = NULL;
+	__atomic_add_fetch(&t->shared->unsettled, batch->count, __ATOMIC_SEQ_CST);
+	hdaCountInflight(t->shared, batch, 1);
+	HdaThread *to = &t->shared->workers[owner];
+	batch->next = __atomic_load_n(&to->inbox, __ATOMIC_RELAXED);
+	while (!__atomic_compare_exchange_n(&to->inbox, &batch->next, batch, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+static void hdaFlush(HdaThread *t) {
+	for (int owner = 0; owner < t->shared->threads; owner++) {
+		if (t->outboxes[owner] != NULL) {
+			hdaSend(t, owner);
+		}
+	}
+	t->outboxF = INT32_MAX;
+}
+
+// publishes the lowest f this thread holds as its layer, returns the lowest in the open list
+static int hdaPublish(HdaThread *t) {
+	const AStarSearch *s = &t->search;
+	const int open = s->openCount ? (int)s->open[0].f : INT32_MAX;
+	const int layer = open < t->outboxF ? open : t->outboxF;
+	if (layer != t->layer) {
+		__atomic_store_n(&t->layer, layer, __ATOMIC_SEQ_CST);
+	}
+	const int depth = s->openCount ? s->open[0].g : 0;
+	if (depth != t->depth) {
+		__atomic_store_n(&t->depth, depth, __ATOMIC_RELAXED);
+	}
+	return open;
+}
+
+// adds a board reached with g moves to this thread's search, or improves its path
+// h is its estimate if it's known already, or -1
+static void hdaAdd(HdaThread *t, const unsigned char *cells, int g, int h, int parent, int parentOwner, char move) {
+	AStarSearch *s = &t->search;
+	HdaShared *shared = t->shared;
+	int *slot = findSlot(s, cells);
+	int node;
+	if (*slot) {
+		node = *slot - 1;
+		if (s->nodes[node].g <= g) {
+			return;
+		}
+		s->nodes[node].closed = false;
+	}
+	else {
+		if (h < 0) {
+			Board board = *shared->start;
+			memcpy(board.cells, cells, s->n);
+			h = shared->heuristic->estimate(&board);
+		}
+		if (g + h >= __atomic_load_n(&shared->best, __ATOMIC_RELAXED)) {
+			return;
+		}
+		const int capacity = s->capacity;
+		node = addNode(s, cells, slot);
+		if (s->capacity != capacity) {
+			t->parentOwners = realloc(t->parentOwners, s->capacity);
+		}
+		s->nodes[node].h = h;
+		s->nodes[node].closed = false;
+		t->generated++;
+	}
+	s->nodes[node].parent = parent;
+	s->nodes[node].g = g;
+	s->nodes[node].move = move;
+	t->parentOwners[node] = parentOwner;
+	pushOpen(s, (OpenEntry){g + s->nodes[node].h, g, node});
+}
+
+// takes everything in the inbox, returns how many messages there were
+// the boards only come off inflight once the layer shows them
+static long hdaReceive(HdaThread *t) {
+	HdaBatch *batches = __atomic_exchange_n(&t->inbox, NULL, __ATOMIC_ACQUIRE);
+	if (batches == NULL) {
+		return 0;
+	}
+	long count = 0;
+	for (HdaBatch *batch = batches; batch != NULL; batch = batch->next) {
+		for (int i = 0; i < batch->count; i++) {
+			const HdaMessage *m = &batch->messages[i];
+			hdaAdd(t, m->cells, m->g, m->h, m->parent, m->parentOwner, m->move);
+		}
+		count += batch->count;
+	}
+	hdaPublish(t);
+	while (batches != NULL) {
+		hdaCountInflight(t->shared, batches, -1);
+		HdaBatch *next = batches->next;
+		free(batches);
+		batches = next;
+	}
+	return count;
+}
+
+static void hdaExpand(HdaThread *t, int node) {
+	HdaShared *shared = t->shared;
+	AStarSearch *s = &t->search;
+	Board board = *shared->start;
+	memcpy(board.cells, &s->cells[node * (long)s->n], s->n);
+	for (board.blank = 0; board.cells[board.blank]; board.blank++);
+	if (isGoal(&board)) {
+		pthread_mutex_lock(&shared->goalLock);
+		if (s->nodes[node].g < shared->best) {
+			__atomic_store_n(&shared->best, s->nodes[node].g, __ATOMIC_RELAXED);
+			shared->goalOwner = t->id;
+			shared->goalNode = node;
+		}
+		pthread_mutex_unlock(&shared->goalLock);
+		return;
+	}
+	t->expanded++;
+
+	const int g = s->nodes[node].g + 1;
+	const int parentMove = s->nodes[node].parent < 0 ? -1 : moveFromChar(s->nodes[node].move);
+	for (int move = 0; move < 4; move++) {
+		if (!canMove(&board, move) || (parentMove >= 0 && move == OPPOSITE_MOVE(parentMove))) {
+			continue;
+		}
+		applyMove(&board, move);
+		const int owner = hdaOwner(board.cells, s->n, shared->threads);
+		if (owner == t->id) {
+			hdaAdd(t, board.cells, g, -1, node, t->id, moveChars[move]);
+		}
+		else {
+			const int h = shared->heuristic->estimate(&board);
+			if (g + h >= __atomic_load_n(&shared->best, __ATOMIC_RELAXED)) {
+				applyMove(&board, OPPOSITE_MOVE(move));
+				continue;
+			}
+			HdaBatch *batch = t->outboxes[owner];
+			if (batch == NULL) {
+				batch = t->outboxes[owner] = malloc(sizeof(HdaBatch));
+				batch->count = 0;
+			}
+			HdaMessage *m = &batch->messages[batch->count++];
+			memcpy(m->cells, board.cells, s->n);
+			m->g = g;
+			m->h = h;
+			t->outboxF = g + h < t->outboxF ? g + h : t->outboxF;
+			m->parent = node;
+			m->parentOwner = t->id;
+			m->move = moveChars[move];
+			t->messages++;
+			if (batch->count == HDA_BATCH) {
+				hdaSend(t, owner);
+			}
+		}
+		applyMove(&board, OPPOSITE_MOVE(move));
+	}
+}
+
+static bool hdaLowerLayer(const HdaShared *shared, int f) {
+	for (int i = 0; i < shared->threads; i++) {
+		if (__atomic_load_n(&shared->workers[i].layer, __ATOMIC_SEQ_CST) < f) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// whether there's a board anywhere with a lower f than the best in this thread's open list,
+// including in its own outboxes
+static bool hdaAhead(HdaThread *t) {
+	const HdaShared *shared = t->shared;
+	const int open = hdaPublish(t);
+	if (t->outboxF < open || hdaLowerLayer(shared, open)) {
+		return true;
+	}
+	for (int f = 0; f < open && f < HDA_MAX_F; f++) {
+		if (__atomic_load_n(&shared->inflight[f], __ATOMIC_SEQ_CST)) {
+			return true;
+		}
+	}
+	return hdaLowerLayer(shared, open);
+}
+
+// whether another thread has a deeper board in the same layer. a serial search takes those
+// first, and in the last layer that's what finds the goal early
+static bool hdaDeeper(const HdaThread *t) {
+	for (int i = 0; i < t->shared->threads; i++) {
+		const HdaThread *other = &t->shared->workers[i];
+		if (__atomic_load_n(&other->layer, __ATOMIC_RELAXED) == t->layer
+				&& __atomic_load_n(&other->depth, __ATOMIC_RELAXED) > t->depth) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// pops boards until one is worth expanding, returns -1 if none are
+static int hdaNext(HdaThread *t) {
+	AStarSearch *s = &t->search;
+	while (s->openCount) {
+		if (s->open[0].f >= __atomic_load_n(&t->shared->best, __ATOMIC_RELAXED)) {
+			return -1;
+		}
+		const OpenEntry entry = popOpen(s);
+		SearchNode *node = &s->nodes[entry.node];
+		if (node->closed || entry.g != node->g) {
+			continue;
+		}
+		node->closed = true;
+		return entry.node;
+	}
+	return -1;
+}
+
+static void *hdaWork(void *arg) {
+	HdaThread *t = arg;
+	HdaShared *shared = t->shared;
+	long held = t->id == 0; // the start board
+	long sinceFlush = 0;
+	for (;;) {
+		held += hdaReceive(t);
+		if (!shared->stop && hdaAhead(t)) {
+			hdaFlush(t);
+			sinceFlush = 0;
+			sched_yield();
+			continue;
+		}
+		if (!shared->stop && hdaDeeper(t)) {
+			hdaFlush(t);
+			sinceFlush = 0;
+			sched_yield();
+		}
+		const int node = hdaNext(t);
+		if (node >= 0) {
+			hdaExpand(t, node);
+			if (++sinceFlush == HDA_FLUSH_EVERY) {
+				hdaFlush(t);
+				sinceFlush = 0;
+				if (limitReached(shared->limit, t->search.count * (long)shared->threads)) {
+					shared->stop = true;
+				}
+			}
+			if (!shared->stop) {
+				continue;
+			}
+		}
+		// idle: everything sent has been counted, so what was received can be settled
+		hdaFlush(t);
+		sinceFlush = 0;
+		__atomic_store_n(&t->layer, INT32_MAX, __ATOMIC_SEQ_CST);
+		if (held) {
+			__atomic_sub_fetch(&shared->unsettled, held, __ATOMIC_SEQ_CST);
+			held = 0;
+		}
+		while (__atomic_load_n(&t->inbox, __ATOMIC_ACQUIRE) == NULL) {
+			if (!__atomic_load_n(&shared->unsettled, __ATOMIC_SEQ_CST) || shared->stop) {
+				return NULL;
+			}
+			sched_yield();
+		}
+	}
+}
+
+// writes an optimal solution in to moves using threads threads and returns its length
+// returns -1 if it won't fit in capacity or if limit stopped the search
+// the heuristic has to be safe to call from several threads once it's been called once
+int solveParallel(const Board *start, const Heuristic *heuristic, int threads, const SearchLimit *limit,
+		char *moves, int capacity, HdaStats *stats) {
+	memset(stats, 0, sizeof(HdaStats));
+	const int n = start->rows * start->cols;
+	if (n > HDA_MAX_CELLS) {
+		return -1;
+	}
+	threads = threads < 1 ? 1 : threads > HDA_MAX_THREADS ? HDA_MAX_THREADS : threads;
+	heuristic->estimate(start); // builds any tables before there are threads
+
+	HdaShared shared = {start, heuristic, limit, threads};
+	shared.workers = calloc(threads, sizeof(HdaThread));
+	shared.unsettled = 1;
+	shared.best = INT32_MAX;
+	shared.goalOwner = -1;
+	pthread_mutex_init(&shared.goalLock, NULL);
+	for (int i = 0; i < threads; i++) {
+		HdaThread *t = &shared.workers[i];
+		t->shared = &shared;
+		t->id = i;
+		AStarSearch *s = &t->search;
+		s->n = n;
+		s->capacity = 1 << 12;
+		s->nodes = malloc(s->capacity * sizeof(SearchNode));
+		s->cells = malloc(s->capacity * (long)n);
+		s->tableMask = (1 << 13) - 1;
+		s->table = calloc(s->tableMask + 1, sizeof(int));
+		s->openCapacity = 1 << 12;
+		s->open = malloc(s->openCapacity * sizeof(OpenEntry));
+		t->parentOwners = malloc(s->capacity);
+		t->layer = INT32_MAX;
+		t->outboxF = INT32_MAX;
+	}
+	// the start goes to thread 0 whatever its hash, nothing else can lead back to it shorter
+	hdaAdd(&shared.workers[0], start->cells, 0, -1, -1, 0, 0);
+
+	pthread_t ids[HDA_MAX_THREADS];
+	for (int i = 1; i < threads; i++) {
+		pthread_create(&ids[i], NULL, &hdaWork, &shared.workers[i]);
+	}
+	hdaWork(&shared.workers[0]);
+	for (int i = 1; i < threads; i++) {
+		pthread_join(ids[i], NULL);
+	}
+
+	int length = -1;
+	if (shared.goalOwner >= 0 && !shared.stop) {
+		length = shared.best;
+		if (length <= capacity) {
+			int owner = shared.goalOwner;
+			int node = shared.goalNode;
+			for (int i = length - 1; i >= 0; i--) {
+				const HdaThread *t = &shared.workers[owner];
+				moves[i] = t->search.nodes[node].move;
+				owner = t->parentOwners[node];
+				node = t->search.nodes[node].parent;
+			}
+		}
+		else {
+			length = -1;
+		}
+	}
+
+	stats->stopped = shared.stop;
+	for (int i = 0; i < threads; i++) {
+		HdaThread *t = &shared.workers[i];
+		stats->expanded += t->expanded;
+		stats->generated += t->generated;
+		stats->messages += t->messages;
+		stats->maxExpanded = t->expanded > stats->maxExpanded ? t->expanded : stats->maxExpanded;
+		// anything left over when the limit stopped it
+		for (HdaBatch *batch = t->inbox, *next; batch != NULL; batch = next) {
+			next = batch->next;
+			free(batch);
+		}
+		for (int owner = 0; owner < threads; owner++) {
+			free(t->outboxes[owner]);
+		}
+		freeSearch(&t->search);
+		free(t->parentOwners);
+	}
+	pthread_mutex_destroy(&shared.goalLock);
+	free(shared.workers);
+	return length;
+}
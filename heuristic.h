@@ -0,0 +1,198 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "board.h"
+
+// admissible estimates of how many moves a board is from a target layout
+
+// number of moves it would take a tile to get from one cell to another on an empty board
+static inline int cellDistance(int from, int to, int cols) {
+	return abs(from / cols - to / cols) + abs(from % cols - to % cols);
+}
+
+// sum of the manhattan distances of every tile but 0 from where it is in the target
+// target[v] is the cell v should end up in
+int manhattanTo(const Board *board, const unsigned char *target) {
+	int total = 0;
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		if (board->cells[i]) {
+			total += cellDistance(i, target[board->cells[i]], board->cols);
+		}
+	}
+	return total;
+}
+
+// how much the manhattan distance changes when 0 makes move
+// target[v] is the cell v should end up in
+static inline int manhattanDelta(const Board *board, const unsigned char *target, int move) {
+	const int from = board->blank + moveOffset(board, move);
+	const int tile = board->cells[from];
+	// the tile slides in to where 0 was
+	return cellDistance(board->blank, target[tile], board->cols) - cellDistance(from, target[tile], board->cols);
+}
+
+// length of the longest strictly increasing subsequence of values
+static int longestIncreasing(const int *values, int count) {
+	int lengths[MAX_CELLS];
+	int longest = 0;
+	for (int i = 0; i < count; i++) {
+		lengths[i] = 1;
+		for (int j = 0; j < i; j++) {
+			if (values[j] < values[i] && lengths[j] + 1 > lengths[i]) {
+				lengths[i] = lengths[j] + 1;
+			}
+		}
+		longest = lengths[i] > longest ? lengths[i] : longest;
+	}
+	return longest;
+}
+
+// tables for one board shape, so estimating to the goal is looking things up instead of dividing
+//
+// a line's digits say cell by cell which of the line's own tiles is there: 0 for none, otherwise
+// 1 + where along the line it belongs. read as a number in base length + 1 they index a table of
+// how many tiles have to leave the line (see linearConflict), made once for every way a line of
+// that length can look. lines longer than SHAPE_MAX_LINE would need too big a table and are
+// worked out each time instead
+
+#define SHAPE_MAX_LINE 7 // 8^7 entries, 2MB
+
+typedef struct ShapeTables {
+	int rows;
+	int cols;
+	unsigned char *manhattan; // of tile v in cell i at v * cells + i, 0 for the 0
+	unsigned char *digits[2]; // rows then columns, of tile v in cell i at v * cells + i
+	const unsigned char *leaving[2]; // rows then columns, by the line's digits, NULL if it's too long
+} ShapeTables;
+
+// the leaving table for lines of length, kept for good once made since any shape may want it
+// the first call for a length mustn't race with another, shapeTables makes both of a shape's
+const unsigned char *leavingTable(int length) {
+	static unsigned char *tables[SHAPE_MAX_LINE + 1];
+	if (length > SHAPE_MAX_LINE) {
+		return NULL;
+	}
+	if (tables[length] == NULL) {
+		long entries = 1;
+		for (int i = 0; i < length; i++) {
+			entries *= length + 1;
+		}
+		tables[length] = malloc(entries);
+		for (long code = 0; code < entries; code++) {
+			// the first cell is the most significant digit
+			int values[SHAPE_MAX_LINE];
+			int count = 0;
+			long place = entries / (length + 1);
+			for (int i = 0; i < length; i++, place /= length + 1) {
+				const int digit = code / place % (length + 1);
+				if (digit) {
+					values[count++] = digit - 1;
+				}
+			}
+			tables[length][code] = count - longestIncreasing(values, count);
+		}
+	}
+	return tables[length];
+}
+
+// the tables for the last board shape asked for, made the first time they're needed
+// not thread safe while it makes them: call it once for the shape before starting threads
+// that estimate, the way hda.h and generate.c do. after that threads only read them
+ShapeTables *shapeTables(int rows, int cols) {
+	static ShapeTables *tables = NULL;
+	if (tables == NULL) {
+		tables = calloc(1, sizeof(ShapeTables));
+	}
+	if (tables->rows != rows || tables->cols != cols) {
+		const int n = rows * cols;
+		free(tables->manhattan);
+		free(tables->digits[0]);
+		free(tables->digits[1]);
+		tables->rows = rows;
+		tables->cols = cols;
+		tables->manhattan = malloc(n * n);
+		tables->digits[0] = malloc(n * n);
+		tables->digits[1] = malloc(n * n);
+		for (int v = 0; v < n; v++) {
+			for (int i = 0; i < n; i++) {
+				tables->manhattan[v * n + i] = v ? cellDistance(i, v, cols) : 0;
+				tables->digits[0][v * n + i] = v && v / cols == i / cols ? v % cols + 1 : 0;
+				tables->digits[1][v * n + i] = v && v % cols == i % cols ? v / cols + 1 : 0;
+			}
+		}
+		tables->leaving[0] = leavingTable(cols);
+		tables->leaving[1] = leavingTable(rows);
+	}
+	return tables;
+}
+
+// manhattan distance to the goal layout, where v belongs in cell v
+int manhattan(const Board *board) {
+	const ShapeTables *tables = shapeTables(board->rows, board->cols);
+	const int n = board->rows * board->cols;
+	int total = 0;
+	for (int i = 0; i < n; i++) {
+		total += tables->manhattan[board->cells[i] * n + i];
+	}
+	return total;
+}
+
+// how many tiles have to leave line of a board, which is a row if direction is 0 and a column if
+// it's 1, going by the line's digits
+static inline int lineLeaving(const ShapeTables *tables, const Board *board, int direction, int line) {
+	const int n = board->rows * board->cols;
+	const int length = direction ? board->rows : board->cols;
+	const int first = direction ? line : line * board->cols;
+	const int step = direction ? board->cols : 1;
+	const unsigned char *digits = tables->digits[direction];
+	if (tables->leaving[direction] != NULL) {
+		uint32_t code = 0;
+		for (int i = first, k = 0; k < length; i += step, k++) {
+			code = code * (length + 1) + digits[board->cells[i] * n + i];
+		}
+		return tables->leaving[direction][code];
+	}
+	int values[MAX_CELLS];
+	int count = 0;
+	for (int i = first, k = 0; k < length; i += step, k++) {
+		const int digit = digits[board->cells[i] * n + i];
+		if (digit) {
+			values[count++] = digit - 1;
+		}
+	}
+	return count - longestIncreasing(values, count);
+}
+
+// manhattan distance plus linear conflicts
+// tiles already in their goal row that are in the wrong order can't pass each other
+// without one of them leaving the row and coming back, which is 2 moves manhattan
+// doesn't count. the fewest tiles that have to leave are the ones not in the longest
+// run that's already in order. same for columns
+int linearConflict(const Board *board) {
+	const ShapeTables *tables = shapeTables(board->rows, board->cols);
+	int leaving = 0;
+	for (int y = 0; y < board->rows; y++) {
+		leaving += lineLeaving(tables, board, 0, y);
+	}
+	for (int x = 0; x < board->cols; x++) {
+		leaving += lineLeaving(tables, board, 1, x);
+	}
+	return manhattan(board) + 2 * leaving;
+}
+
+// what a heuristic that follows a board move by move keeps about it
+typedef uint64_t HeuristicState;
+
+// a heuristic the searches can be configured with
+// one that can follow a board move by move also has start, follow and value, and NULL otherwise:
+// start gives the state of a board, follow the state after a move, taken before it's made,
+// and value the estimate once the board has been moved to match the state
+typedef struct Heuristic {
+	const char *name;
+	int (*estimate)(const Board *board);
+	HeuristicState (*start)(const Board *board);
+	HeuristicState (*follow)(HeuristicState state, const Board *board, int move);
+	int (*value)(HeuristicState state, const Board *board);
+} Heuristic;
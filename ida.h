@@ -0,0 +1,135 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "astar.h"
+#include "fsm_table.h"
+#include "perimeter.h"
+
+// iterative deepening A*: depth first searches, each cut off where g + h passes a bound
+// that starts at h of the start and goes up to the lowest g + h cut off last time.
+// keeps nothing but the path, so it never runs out of memory, but a board reached
+// by two different paths is searched twice.
+// with fsm it follows gen_fsm.c's automaton along the path and skips any move the
+// automaton rejects, which drops short cycles and move orders that are always duplicates.
+// without it, it only skips undoing the last move.
+// with a perimeter (see perimeter.h) a board in it ends the search with its exact distance,
+// and one outside is at least the perimeter's depth + 1 from the goal
+
+#define IDA_FOUND -1
+
+typedef struct IdaStats {
+	long expanded;
+	long pruned; // moves the automaton rejected beyond undoing the last move
+	long perimeterHits; // boards looked up and found in the perimeter
+	int iterations;
+	bool stopped; // gave up because of the limit
+} IdaStats;
+
+typedef struct IdaSearch {
+	Board board;
+	const Heuristic *heuristic;
+	const SearchLimit *limit;
+	bool fsm;
+	const Perimeter *perimeter;
+	char *moves;
+	int capacity;
+	int length; // of the solution once it's found
+	IdaStats *stats;
+} IdaSearch;
+
+// returns IDA_FOUND with the path in moves, or the lowest g + h over bound it cut off at
+// estimate is the heuristic's state for the board if it follows moves
+static int idaSearch(IdaSearch *s, int g, int bound, int lastMove, int state, HeuristicState estimate) {
+	const Heuristic *heuristic = s->heuristic;
+	int h = heuristic->value != NULL ? heuristic->value(estimate, &s->board) : heuristic->estimate(&s->board);
+	// nothing with a higher h can be in the perimeter
+	if (s->perimeter != NULL && h <= s->perimeter->header.depth) {
+		const int distance = perimeterDistance(s->perimeter, &s->board);
+		if (distance == PERIMETER_OUTSIDE) {
+			const int outside = perimeterOutside(s->perimeter, &s->board);
+			h = outside > h ? outside : h;
+		}
+		else {
+			if (g + distance > bound) {
+				return g + distance;
+			}
+			s->stats->perimeterHits++;
+			if (g + distance > s->capacity) {
+				return INT32_MAX;
+			}
+			perimeterPath(s->perimeter, &s->board, distance, s->moves + g);
+			s->length = g + distance;
+			return IDA_FOUND;
+		}
+	}
+	const int f = g + h;
+	if (f > bound) {
+		return f;
+	}
+	if (isGoal(&s->board)) {
+		s->length = g;
+		return IDA_FOUND;
+	}
+	if (g == s->capacity) {
+		return INT32_MAX;
+	}
+	s->stats->expanded++;
+	if (!(s->stats->expanded & 1023) && limitReached(s->limit, s->stats->expanded)) {
+		s->stats->stopped = true;
+		return INT32_MAX;
+	}
+	int next = INT32_MAX;
+	for (int move = 0; move < 4; move++) {
+		if (!canMove(&s->board, move) || (lastMove >= 0 && move == OPPOSITE_MOVE(lastMove))) {
+			continue;
+		}
+		int nextState = 0;
+		if (s->fsm) {
+			nextState = fsmTable[state][move];
+			if (nextState == FSM_PRUNED) {
+				s->stats->pruned++;
+				continue;
+			}
+		}
+		const HeuristicState nextEstimate = heuristic->follow != NULL ? heuristic->follow(estimate, &s->board, move) : 0;
+		applyMove(&s->board, move);
+		s->moves[g] = moveChars[move];
+		const int result = idaSearch(s, g + 1, bound, move, nextState, nextEstimate);
+		applyMove(&s->board, OPPOSITE_MOVE(move));
+		if (result == IDA_FOUND) {
+			return IDA_FOUND;
+		}
+		if (s->stats->stopped) {
+			return INT32_MAX;
+		}
+		next = result < next ? result : next;
+	}
+	return next;
+}
+
+// writes an optimal solution in to moves and returns its length
+// returns -1 if there's none that fits in capacity or if limit stopped the search
+// perimeter may be NULL, and otherwise must be for the same size as start
+int solveIda(const Board *start, const Heuristic *heuristic, bool fsm, const Perimeter *perimeter,
+		const SearchLimit *limit, char *moves, int capacity, IdaStats *stats) {
+	memset(stats, 0, sizeof(IdaStats));
+	IdaSearch s = {*start, heuristic, limit, fsm, perimeter, moves, capacity, 0, stats};
+	int bound = heuristic->estimate(start);
+	const HeuristicState estimate = heuristic->start != NULL ? heuristic->start(start) : 0;
+	for (;;) {
+		stats->iterations++;
+		const int result = idaSearch(&s, 0, bound, -1, 0, estimate);
+		if (result == IDA_FOUND) {
+			return s.length;
+		}
+		if (result == INT32_MAX) {
+			return -1;
+		}
+		bound = result;
+	}
+}
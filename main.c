@@ -103,6 +103,7 @@ int main(int argc, char *argv[]) {
 
 	game.y = game.x = 0;
 	game.undo = NULL;
+	game.offscreen = NULL;
 	init(&game);
 
 	// game loop
@@ -0,0 +1,831 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "random_board.h"
+
+// additive pattern databases
+//
+// the tiles are split in to groups. for each group a breadth first search from the goal
+// over where just those tiles and the 0 are finds how many moves of the group's tiles
+// it takes to get them home, not counting moves of any other tile. since every move
+// moves a tile of exactly one group, the sum over the groups never overestimates
+//
+// a state is stored as the mixed radix number pos(0) + pos(tile 1) * n + pos(tile 2) * n^2 ...
+// so no ranking is needed while searching, at the cost of some entries that can't happen.
+// the final tables drop the 0, which is just dividing by n
+//
+// on a square board a group reflected in the main diagonal (transposeBoard) is as far from home
+// on a board as the group is on the reflected board, so a group and its reflection share a table.
+// the groups are picked so as many as possible come in such pairs, see symmetricGroups
+
+#define PDB_MAX_BUILD (1 << 24) // largest index space a group's search may use
+#define PDB_MAX_GROUP 7
+#define PDB_UNSEEN 0xff
+#define PDB_SAMPLE 1000 // random boards splits are compared on
+#define PDB_FILE_MAGIC "NPZD"
+#define PDB_FILE_VERSION 1 // bumped whenever the file layout changes
+
+typedef struct PatternGroup {
+	int size;
+	unsigned char tiles[PDB_MAX_GROUP];
+	int owner; // the group whose table this one uses, itself unless it's that group's reflection
+	unsigned char *distances; // indexed by the positions of the tiles, without the 0, reflected if it isn't the owner
+} PatternGroup;
+
+// where built databases are kept between runs, NULL for nowhere
+const char *patternCacheDir = NULL;
+
+typedef struct PatternDatabase {
+	int rows;
+	int cols;
+	int groupCount;
+	PatternGroup groups[MAX_CELLS];
+	unsigned char cellMaps[2][MAX_CELLS]; // each cell as it is and reflected, for groups that own their table and ones that don't
+} PatternDatabase;
+
+// largest group size whose search fits in PDB_MAX_BUILD
+int patternGroupSize(int rows, int cols) {
+	const long n = rows * cols;
+	long space = n * n;
+	int size = 1;
+	while (size < PDB_MAX_GROUP && size < n - 1 && space * n <= PDB_MAX_BUILD) {
+		space *= n;
+		size++;
+	}
+	return size;
+}
+
+// the search is level by level so any number of threads can share it. every state at the
+// level's distance is expanded once: free moves (the 0 moving through other tiles) lower their
+// neighbour to the same distance and the thread goes on to expand it straight away, moves of the
+// group's tiles lower theirs to one more and it goes in the thread's own slab for the next level.
+// entries are lowered with a byte compare and swap, so the threads never lock, and a state
+// expanded this level gets PDB_EXPANDED set on its distance so no other thread expands it again.
+// threads take the level a chunk at a time. free moves only change the lowest digit, so
+// following them stays within a few cache lines
+
+#define PDB_EXPANDED 0x80 // distances stay below it while building
+#define PDB_CHUNK 1024 // states of a level a thread takes at a time
+
+typedef struct PatternSlab {
+	uint32_t *states;
+	long count;
+	long capacity;
+} PatternSlab;
+
+typedef struct PatternBuild {
+	const PatternGroup *group;
+	int rows;
+	int cols;
+	uint32_t powers[PDB_MAX_GROUP + 2];
+	unsigned char *distances;
+	int distance; // of the level being expanded
+	bool shared; // whether there's more than one thread
+	const uint32_t *level; // states lowered to distance last level
+	long levelCount;
+	long nextState; // where the next chunk of level starts
+	long expanded;
+	PatternSlab *slabs; // per thread, states lowered to distance + 1
+} PatternBuild;
+
+typedef struct PatternWorker {
+	PatternBuild *build;
+	int thread;
+} PatternWorker;
+
+static void pushSlab(PatternSlab *slab, uint32_t state) {
+	if (slab->count == slab->capacity) {
+		slab->capacity *= 2;
+		slab->states = realloc(slab->states, slab->capacity * sizeof(uint32_t));
+	}
+	slab->states[slab->count++] = state;
+}
+
+// lowers distances[state] to distance, writing value, returns whether it was higher
+// on one thread there's nothing to race with, and a locked compare and swap costs a lot
+static inline bool lowerPattern(unsigned char *distances, uint32_t state, int distance, unsigned char value, bool shared) {
+	// PDB_UNSEEN reads as more than any distance
+	unsigned char old = __atomic_load_n(&distances[state], __ATOMIC_RELAXED);
+	while ((old & ~PDB_EXPANDED) > distance) {
+		if (!shared) {
+			distances[state] = value;
+			return true;
+		}
+		if (__atomic_compare_exchange_n(&distances[state], &old, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// sets PDB_EXPANDED on state if it's at distance and nobody has yet
+static inline bool claimPattern(unsigned char *distances, uint32_t state, int distance, bool shared) {
+	if (!shared) {
+		const bool unclaimed = distances[state] == distance;
+		distances[state] |= unclaimed ? PDB_EXPANDED : 0;
+		return unclaimed;
+	}
+	unsigned char value = distance;
+	return __atomic_compare_exchange_n(&distances[state], &value, distance | PDB_EXPANDED, false,
+		__ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+// expands state, which is at the level's distance, pushing free neighbours on to stack
+static void expandPattern(PatternBuild *b, uint32_t state, PatternSlab *stack, PatternSlab *next) {
+	const PatternGroup *group = b->group;
+	const int n = b->rows * b->cols;
+	const int cols = b->cols;
+	const int distance = b->distance;
+	const int blank = state % n;
+	int positions[PDB_MAX_GROUP];
+	for (int i = 0; i < group->size; i++) {
+		positions[i] = state / b->powers[i + 1] % n;
+	}
+	for (int move = 0; move < 4; move++) {
+		int to;
+		switch (move) {
+			case MOVE_UP:
+				to = blank < cols ? -1 : blank - cols;
+				break;
+			case MOVE_DOWN:
+				to = blank + cols >= n ? -1 : blank + cols;
+				break;
+			case MOVE_RIGHT:
+				to = blank % cols == cols - 1 ? -1 : blank + 1;
+				break;
+			default:
+				to = blank % cols == 0 ? -1 : blank - 1;
+		}
+		if (to < 0) {
+			continue;
+		}
+		uint32_t neighbour = state - blank + to;
+		int cost = 0;
+		for (int i = 0; i < group->size; i++) {
+			if (positions[i] == to) {
+				neighbour += (blank - to) * (int64_t)b->powers[i + 1];
+				cost = 1;
+				break;
+			}
+		}
+		if (cost) {
+			if (lowerPattern(b->distances, neighbour, distance + 1, distance + 1, b->shared)) {
+				pushSlab(next, neighbour);
+			}
+		}
+		else if (lowerPattern(b->distances, neighbour, distance, distance | PDB_EXPANDED, b->shared)) {
+			pushSlab(stack, neighbour);
+		}
+	}
+}
+
+// one thread's share of a level
+static void *patternWorker(void *arg) {
+	const PatternWorker *w = arg;
+	PatternBuild *b = w->build;
+	PatternSlab *next = &b->slabs[w->thread];
+	PatternSlab stack = {malloc((1 << 10) * sizeof(uint32_t)), 0, 1 << 10};
+	long expanded = 0;
+	for (;;) {
+		const long first = __atomic_fetch_add(&b->nextState, PDB_CHUNK, __ATOMIC_RELAXED);
+		if (first >= b->levelCount) {
+			break;
+		}
+		const long last = first + PDB_CHUNK < b->levelCount ? first + PDB_CHUNK : b->levelCount;
+		for (long i = first; i < last; i++) {
+			// it may have been lowered again and expanded already
+			if (!claimPattern(b->distances, b->level[i], b->distance, b->shared)) {
+				continue;
+			}
+			pushSlab(&stack, b->level[i]);
+			while (stack.count) {
+				expandPattern(b, stack.states[--stack.count], &stack, next);
+				expanded++;
+			}
+		}
+	}
+	free(stack.states);
+	__atomic_fetch_add(&b->expanded, expanded, __ATOMIC_RELAXED);
+	return NULL;
+}
+
+// fills group->distances with a 0-1 breadth first search from the goal on threads threads:
+// moving one of the group's tiles costs 1, moving anything else is free
+// returns how many states were expanded
+long buildPatternGroup(PatternGroup *group, int rows, int cols, int threads) {
+	const int n = rows * cols;
+	const int digits = group->size + 1;
+	PatternBuild b = {group, rows, cols};
+	b.powers[0] = 1;
+	for (int i = 1; i <= digits; i++) {
+		b.powers[i] = b.powers[i - 1] * n;
+	}
+	b.distances = malloc(b.powers[digits]);
+	memset(b.distances, PDB_UNSEEN, b.powers[digits]);
+	b.slabs = malloc(threads * sizeof(PatternSlab));
+	for (int i = 0; i < threads; i++) {
+		b.slabs[i] = (PatternSlab){malloc((1 << 10) * sizeof(uint32_t)), 0, 1 << 10};
+	}
+
+	uint32_t goal = 0; // the 0 is home at 0
+	for (int i = 0; i < group->size; i++) {
+		goal += group->tiles[i] * b.powers[i + 1];
+	}
+	b.distances[goal] = 0;
+	b.shared = threads > 1;
+	PatternSlab level = {malloc(sizeof(uint32_t)), 1, 1};
+	level.states[0] = goal;
+
+	pthread_t threadIds[threads];
+	PatternWorker workers[threads];
+	for (; level.count; b.distance++) {
+		b.level = level.states;
+		b.levelCount = level.count;
+		b.nextState = 0;
+		for (int i = 0; i < threads; i++) {
+			workers[i] = (PatternWorker){&b, i};
+			if (i) {
+				pthread_create(&threadIds[i], NULL, &patternWorker, &workers[i]);
+			}
+		}
+		patternWorker(&workers[0]);
+		for (int i = 1; i < threads; i++) {
+			pthread_join(threadIds[i], NULL);
+		}
+		// the next level is every thread's slab
+		level.count = 0;
+		for (int i = 0; i < threads; i++) {
+			for (long j = 0; j < b.slabs[i].count; j++) {
+				pushSlab(&level, b.slabs[i].states[j]);
+			}
+			b.slabs[i].count = 0;
+		}
+	}
+	for (int i = 0; i < threads; i++) {
+		free(b.slabs[i].states);
+	}
+	free(b.slabs);
+	free(level.states);
+
+	// where the 0 is doesn't matter in the end, keep the best
+	group->distances = malloc(b.powers[digits - 1]);
+	memset(group->distances, PDB_UNSEEN, b.powers[digits - 1]);
+	for (uint32_t state = 0; state < b.powers[digits]; state++) {
+		unsigned char *best = &group->distances[state / n];
+		const unsigned char distance = b.distances[state] == PDB_UNSEEN ? PDB_UNSEEN : b.distances[state] & ~PDB_EXPANDED;
+		if (distance < *best) {
+			*best = distance;
+		}
+	}
+	free(b.distances);
+	return b.expanded;
+}
+
+// one thread per core
+int patternThreads() {
+	const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+	return cores < 1 ? 1 : cores;
+}
+
+static PatternGroup *addPatternGroup(PatternDatabase *pdb) {
+	PatternGroup *group = &pdb->groups[pdb->groupCount];
+	group->size = 0;
+	group->owner = pdb->groupCount++;
+	return group;
+}
+
+// splits a side by side board's tiles in to groups of up to size that are either a pair of
+// reflections or their own reflection. the last tiles above the diagonal are taken size at a
+// time, each group followed by its reflection, and what's left, the diagonal and the first tiles
+// above it with their reflections, goes in groups that are their own reflection. those are
+// around where the 0 ends up, which is where groups catch the most.
+// returns false, leaving no groups, if there's no pair or it takes more groups than splitting
+// consecutively
+static bool symmetricGroups(PatternDatabase *pdb, int side, int size) {
+	const int n = side * side;
+	unsigned char above[MAX_CELLS];
+	int aboveCount = 0;
+	for (int tile = 1; tile < n; tile++) {
+		if (tile % side > tile / side) {
+			above[aboveCount++] = tile;
+		}
+	}
+	const int pairs = aboveCount / size;
+	const int leftover = aboveCount - pairs * size;
+	for (int p = 0; p < pairs; p++) {
+		PatternGroup *group = addPatternGroup(pdb);
+		PatternGroup *reflection = addPatternGroup(pdb);
+		reflection->owner = group->owner;
+		for (int i = 0; i < size; i++) {
+			const int tile = above[leftover + p * size + i];
+			group->tiles[group->size++] = tile;
+			reflection->tiles[reflection->size++] = transposeCell(side, side, tile);
+		}
+	}
+	// each leftover tile with its reflection in the first group with room, then the diagonal
+	const int firstOwn = pdb->groupCount;
+	for (int i = 0; i < leftover + side - 1; i++) {
+		const bool diagonal = i >= leftover;
+		const int tile = diagonal ? (i - leftover + 1) * (side + 1) : above[i];
+		const int needed = diagonal ? 1 : 2;
+		PatternGroup *group = NULL;
+		for (int g = firstOwn; g < pdb->groupCount && group == NULL; g++) {
+			group = pdb->groups[g].size + needed <= size ? &pdb->groups[g] : NULL;
+		}
+		group = group == NULL ? addPatternGroup(pdb) : group;
+		group->tiles[group->size++] = tile;
+		if (!diagonal) {
+			group->tiles[group->size++] = transposeCell(side, side, tile);
+		}
+	}
+	if (!pairs || pdb->groupCount > (n - 1 + size - 1) / size) {
+		pdb->groupCount = 0;
+		return false;
+	}
+	return true;
+}
+
+int lookupPatterns(const PatternDatabase *pdb, const Board *board) {
+	const int n = board->rows * board->cols;
+	unsigned char positions[MAX_CELLS];
+	for (int i = 0; i < n; i++) {
+		positions[board->cells[i]] = i;
+	}
+	int total = 0;
+	for (int g = 0; g < pdb->groupCount; g++) {
+		const PatternGroup *group = &pdb->groups[g];
+		const unsigned char *cells = pdb->cellMaps[group->owner != g];
+		uint32_t index = 0;
+		for (int i = group->size - 1; i >= 0; i--) {
+			index = index * n + cells[positions[group->tiles[i]]];
+		}
+		total += group->distances[index];
+	}
+	return total;
+}
+
+// fills pdb with groups of size consecutive tiles in order
+static void orderedGroups(PatternDatabase *pdb, const unsigned char *order, int count, int size) {
+	for (int i = 0; i < count; i += size) {
+		PatternGroup *group = addPatternGroup(pdb);
+		for (int j = i; j < count && j < i + size; j++) {
+			group->tiles[group->size++] = order[j];
+		}
+	}
+}
+
+// fills pdb with height by width blocks of tiles from the top left, smaller at the edges
+static void blockGroups(PatternDatabase *pdb, int rows, int cols, int height, int width) {
+	for (int top = 0; top < rows; top += height) {
+		for (int left = 0; left < cols; left += width) {
+			PatternGroup *group = addPatternGroup(pdb);
+			for (int y = top; y < rows && y < top + height; y++) {
+				for (int x = left; x < cols && x < left + width; x++) {
+					if (y || x) {
+						group->tiles[group->size++] = y * cols + x;
+					}
+				}
+			}
+		}
+	}
+}
+
+// on boards that aren't square some ways of splitting the tiles do much better than others
+// (across the short side beats along the long one by 1.7 moves on 3x5) and which is best depends
+// on the shape, so several are built: consecutive tiles by rows, by columns, and blocks of every
+// shape that fits in size. the one with the highest average estimate over PDB_SAMPLE random
+// boards is kept, and a group that's in more than one is only built once.
+// returns how many states were expanded
+static long choosePatternGroups(PatternDatabase *pdb, int rows, int cols, int size, int threads) {
+	const int n = rows * cols;
+	PatternDatabase *candidates = calloc(2 + size, sizeof(PatternDatabase));
+	int candidateCount = 0;
+	unsigned char order[MAX_CELLS];
+	for (int tile = 1; tile < n; tile++) {
+		order[tile - 1] = tile;
+	}
+	orderedGroups(&candidates[candidateCount++], order, n - 1, size);
+	for (int x = 0, count = 0; x < cols; x++) {
+		for (int y = 0; y < rows; y++) {
+			if (y || x) {
+				order[count++] = y * cols + x;
+			}
+		}
+	}
+	orderedGroups(&candidates[candidateCount++], order, n - 1, size);
+	for (int height = 1; height <= rows && height <= size; height++) {
+		const int width = size / height;
+		if (height > 1 && width > 1 && width <= cols) {
+			blockGroups(&candidates[candidateCount++], rows, cols, height, width);
+		}
+	}
+
+	Board *sample = malloc(PDB_SAMPLE * sizeof(Board));
+	uint64_t state = 1;
+	randomSolvableBoards(&state, rows, cols, sample, PDB_SAMPLE);
+	long expanded = 0;
+	long bestTotal = -1;
+	int best = 0;
+	for (int c = 0; c < candidateCount; c++) {
+		PatternDatabase *candidate = &candidates[c];
+		candidate->rows = rows;
+		candidate->cols = cols;
+		memcpy(candidate->cellMaps, pdb->cellMaps, sizeof(pdb->cellMaps));
+		for (int g = 0; g < candidate->groupCount; g++) {
+			PatternGroup *group = &candidate->groups[g];
+			// the same tiles in the same order have the same table
+			group->distances = NULL;
+			for (int other = 0; other < c && group->distances == NULL; other++) {
+				for (int h = 0; h < candidates[other].groupCount && group->distances == NULL; h++) {
+					const PatternGroup *built = &candidates[other].groups[h];
+					if (built->size == group->size && !memcmp(built->tiles, group->tiles, group->size)) {
+						group->distances = built->distances;
+					}
+				}
+			}
+			if (group->distances == NULL) {
+				expanded += buildPatternGroup(group, rows, cols, threads);
+			}
+		}
+		long total = 0;
+		for (int i = 0; i < PDB_SAMPLE; i++) {
+			total += lookupPatterns(candidate, &sample[i]);
+		}
+		if (total > bestTotal) {
+			bestTotal = total;
+			best = c;
+		}
+	}
+	free(sample);
+
+	// keep the best one's tables and free every other table, each once
+	*pdb = candidates[best];
+	for (int c = 0; c < candidateCount; c++) {
+		for (int g = 0; g < candidates[c].groupCount; g++) {
+			unsigned char *distances = candidates[c].groups[g].distances;
+			bool kept = false;
+			for (int h = 0; h < pdb->groupCount && !kept; h++) {
+				kept = pdb->groups[h].distances == distances;
+			}
+			for (int other = 0; other < c && !kept; other++) {
+				for (int h = 0; h < candidates[other].groupCount && !kept; h++) {
+					kept = candidates[other].groups[h].distances == distances;
+				}
+			}
+			if (!kept) {
+				free(distances);
+			}
+		}
+	}
+	free(candidates);
+	return expanded;
+}
+
+// built databases are kept in patternCacheDir, if it's set, as pdb-<rows>x<cols>: this header,
+// then for each group its size, owner and tiles, then the table of every group that owns one
+typedef struct PatternFileHeader {
+	char magic[4];
+	int version;
+	int rows;
+	int cols;
+	int groupCount;
+} PatternFileHeader;
+
+typedef struct PatternFileGroup {
+	int size;
+	int owner;
+	unsigned char tiles[PDB_MAX_GROUP];
+} PatternFileGroup;
+
+static uint32_t patternTableSize(int n, int size) {
+	uint32_t entries = 1;
+	for (int i = 0; i < size; i++) {
+		entries *= n;
+	}
+	return entries;
+}
+
+// whether the groups split the tiles between them, each exactly once, and every group that
+// doesn't own its table is its owner reflected tile for tile, so a file can't make lookups
+// read out of bounds or count a tile twice
+static bool validPatternGroups(const PatternDatabase *pdb) {
+	const int n = pdb->rows * pdb->cols;
+	bool seen[MAX_CELLS] = {false};
+	int count = 0;
+	for (int g = 0; g < pdb->groupCount; g++) {
+		const PatternGroup *group = &pdb->groups[g];
+		for (int i = 0; i < group->size; i++) {
+			const int tile = group->tiles[i];
+			if (!tile || tile >= n || seen[tile]) {
+				return false;
+			}
+			seen[tile] = true;
+			count++;
+		}
+		if (group->owner != g) {
+			const PatternGroup *owner = &pdb->groups[group->owner];
+			if (pdb->rows != pdb->cols || owner->owner != group->owner || owner->size != group->size) {
+				return false;
+			}
+			for (int i = 0; i < group->size; i++) {
+				if (group->tiles[i] != transposeCell(pdb->rows, pdb->cols, owner->tiles[i])) {
+					return false;
+				}
+			}
+		}
+	}
+	return count == n - 1;
+}
+
+// returns false, leaving no groups, if there's no file for the size or it isn't one
+static bool loadPatternDatabase(PatternDatabase *pdb, const char *path) {
+	FILE *f = fopen(path, "rb");
+	if (f == NULL) {
+		return false;
+	}
+	const int n = pdb->rows * pdb->cols;
+	PatternFileHeader header;
+	bool loaded = fread(&header, sizeof(header), 1, f) == 1 && !memcmp(header.magic, PDB_FILE_MAGIC, 4)
+		&& header.version == PDB_FILE_VERSION && header.rows == pdb->rows && header.cols == pdb->cols && header.groupCount > 0 && header.groupCount < n;
+	pdb->groupCount = 0;
+	for (int g = 0; loaded && g < header.groupCount; g++) {
+		PatternFileGroup fileGroup;
+		loaded = fread(&fileGroup, sizeof(fileGroup), 1, f) == 1 && fileGroup.size > 0
+			&& fileGroup.size <= patternGroupSize(pdb->rows, pdb->cols) && fileGroup.owner >= 0 && fileGroup.owner <= g;
+		if (loaded) {
+			PatternGroup *group = addPatternGroup(pdb);
+			group->size = fileGroup.size;
+			group->owner = fileGroup.owner;
+			group->distances = NULL;
+			memcpy(group->tiles, fileGroup.tiles, PDB_MAX_GROUP);
+		}
+	}
+	loaded = loaded && validPatternGroups(pdb);
+	for (int g = 0; loaded && g < pdb->groupCount; g++) {
+		PatternGroup *group = &pdb->groups[g];
+		if (group->owner == g) {
+			const uint32_t entries = patternTableSize(n, group->size);
+			group->distances = malloc(entries);
+			loaded = fread(group->distances, 1, entries, f) == entries;
+		}
+		else {
+			group->distances = pdb->groups[group->owner].distances;
+		}
+	}
+	loaded = loaded && fgetc(f) == EOF;
+	fclose(f);
+	if (!loaded) {
+		for (int g = 0; g < pdb->groupCount; g++) {
+			if (pdb->groups[g].owner == g) {
+				free(pdb->groups[g].distances);
+			}
+		}
+		pdb->groupCount = 0;
+	}
+	return loaded;
+}
+
+// written under a temporary name and renamed, so a process loading path never sees half of it
+static void savePatternDatabase(const PatternDatabase *pdb, const char *path) {
+	char temporary[4096];
+	snprintf(temporary, sizeof(temporary), "%s.%i", path, getpid());
+	FILE *f = fopen(temporary, "wb");
+	if (f == NULL) {
+		return;
+	}
+	const int n = pdb->rows * pdb->cols;
+	const PatternFileHeader header = {PDB_FILE_MAGIC, PDB_FILE_VERSION, pdb->rows, pdb->cols, pdb->groupCount};
+	bool written = fwrite(&header, sizeof(header), 1, f) == 1;
+	for (int g = 0; written && g < pdb->groupCount; g++) {
+		PatternFileGroup fileGroup = {pdb->groups[g].size, pdb->groups[g].owner};
+		memcpy(fileGroup.tiles, pdb->groups[g].tiles, PDB_MAX_GROUP);
+		written = fwrite(&fileGroup, sizeof(fileGroup), 1, f) == 1;
+	}
+	for (int g = 0; written && g < pdb->groupCount; g++) {
+		if (pdb->groups[g].owner == g) {
+			const uint32_t entries = patternTableSize(n, pdb->groups[g].size);
+			written = fwrite(pdb->groups[g].distances, 1, entries, f) == entries;
+		}
+	}
+	written = !fclose(f) && written && !rename(temporary, path);
+	if (!written) {
+		unlink(temporary);
+	}
+}
+
+// splits the tiles in to groups and builds every group on threads threads: on square boards
+// in reflected pairs if that doesn't take more groups, otherwise consecutive tiles, and on
+// other boards whichever of several splits does best (see choosePatternGroups).
+// loads it from patternCacheDir instead if it's there, and saves it there if it wasn't
+// returns how many states were expanded
+long buildPatternDatabase(PatternDatabase *pdb, int rows, int cols, int threads) {
+	const int n = rows * cols;
+	const int size = patternGroupSize(rows, cols);
+	pdb->rows = rows;
+	pdb->cols = cols;
+	pdb->groupCount = 0;
+	for (int cell = 0; cell < n; cell++) {
+		pdb->cellMaps[0][cell] = cell;
+		pdb->cellMaps[1][cell] = transposeCell(rows, cols, cell);
+	}
+	char path[4096];
+	if (patternCacheDir != NULL) {
+		snprintf(path, sizeof(path), "%s/pdb-%ix%i", patternCacheDir, rows, cols);
+		if (loadPatternDatabase(pdb, path)) {
+			return 0;
+		}
+	}
+	long expanded = 0;
+	if (rows != cols) {
+		expanded = choosePatternGroups(pdb, rows, cols, size, threads);
+	}
+	else {
+		if (!symmetricGroups(pdb, rows, size)) {
+			for (int tile = 1; tile < n; tile += size) {
+				PatternGroup *group = addPatternGroup(pdb);
+				for (int t = tile; t < n && t < tile + size; t++) {
+					group->tiles[group->size++] = t;
+				}
+			}
+		}
+		for (int g = 0; g < pdb->groupCount; g++) {
+			PatternGroup *group = &pdb->groups[g];
+			if (group->owner == g) {
+				expanded += buildPatternGroup(group, rows, cols, threads);
+			}
+			else {
+				group->distances = pdb->groups[group->owner].distances;
+			}
+		}
+	}
+	if (patternCacheDir != NULL) {
+		savePatternDatabase(pdb, path);
+	}
+	return expanded;
+}
+
+void freePatternDatabase(PatternDatabase *pdb) {
+	for (int i = 0; i < pdb->groupCount; i++) {
+		if (pdb->groups[i].owner == i) {
+			free(pdb->groups[i].distances);
+		}
+	}
+	pdb->groupCount = 0;
+}
+
+// the database for the last board size asked for, built the first time it's needed
+// two threads asking first at once would both build it: ask once before starting any threads
+PatternDatabase *patternDatabase(int rows, int cols) {
+	static PatternDatabase *pdb = NULL;
+	if (pdb == NULL) {
+		pdb = calloc(1, sizeof(PatternDatabase));
+	}
+	if (pdb->rows != rows || pdb->cols != cols) {
+		freePatternDatabase(pdb);
+		buildPatternDatabase(pdb, rows, cols, patternThreads());
+	}
+	return pdb;
+}
+
+// on big boards the groups get small enough that linear conflict can beat them
+int patternEstimate(const Board *board) {
+	const int patterns = lookupPatterns(patternDatabase(board->rows, board->cols), board);
+	const int conflict = linearConflict(board);
+	return patterns > conflict ? patterns : conflict;
+}
+
+// packed pattern databases
+//
+// a group's distance only counts moves of its own tiles, each of which changes the manhattan
+// distance of the group's tiles by 1, so it's that manhattan distance plus an even extra, which
+// is rarely more than 6. the packed tables keep half the extra in 2 bits, 4 entries to a byte,
+// capped at PDB_PACKED_MAX. capping can only lower an estimate, so it stays admissible, and the
+// tables are a quarter of the size so more of them stays in cache.
+// every tile is in a group, so the estimate is the manhattan distance plus twice the extras
+
+#define PDB_PACKED_MAX 3
+
+typedef struct PackedGroup {
+	int size;
+	unsigned char tiles[PDB_MAX_GROUP];
+	int owner; // as in PatternGroup
+	unsigned char *extras; // 2 bits each, indexed like PatternGroup.distances
+} PackedGroup;
+
+typedef struct PackedDatabase {
+	int rows;
+	int cols;
+	int groupCount;
+	PackedGroup groups[MAX_CELLS];
+	unsigned char cellMaps[2][MAX_CELLS]; // as in PatternDatabase
+	unsigned char *manhattan; // of tile from cell, at tile * cells + cell
+} PackedDatabase;
+
+// builds the pattern database on threads threads and packs it
+void buildPackedDatabase(PackedDatabase *packed, int rows, int cols, int threads) {
+	const int n = rows * cols;
+	PatternDatabase *pdb = calloc(1, sizeof(PatternDatabase));
+	buildPatternDatabase(pdb, rows, cols, threads);
+	packed->rows = rows;
+	packed->cols = cols;
+	packed->groupCount = pdb->groupCount;
+	memcpy(packed->cellMaps, pdb->cellMaps, sizeof(pdb->cellMaps));
+	packed->manhattan = malloc(n * n);
+	for (int tile = 0; tile < n; tile++) {
+		for (int cell = 0; cell < n; cell++) {
+			packed->manhattan[tile * n + cell] = abs(cell / cols - tile / cols) + abs(cell % cols - tile % cols);
+		}
+	}
+	for (int g = 0; g < pdb->groupCount; g++) {
+		const PatternGroup *group = &pdb->groups[g];
+		PackedGroup *packedGroup = &packed->groups[g];
+		packedGroup->size = group->size;
+		memcpy(packedGroup->tiles, group->tiles, sizeof(group->tiles));
+		packedGroup->owner = group->owner;
+		if (group->owner != g) {
+			packedGroup->extras = packed->groups[group->owner].extras;
+			continue;
+		}
+		uint32_t entries = 1;
+		for (int i = 0; i < group->size; i++) {
+			entries *= n;
+		}
+		packedGroup->extras = calloc((entries + 3) / 4, 1);
+		for (uint32_t index = 0; index < entries; index++) {
+			if (group->distances[index] == PDB_UNSEEN) {
+				continue;
+			}
+			int distance = 0;
+			for (uint32_t i = 0, rest = index; i < group->size; i++, rest /= n) {
+				distance += packed->manhattan[group->tiles[i] * n + rest % n];
+			}
+			int extra = (group->distances[index] - distance) / 2;
+			extra = extra > PDB_PACKED_MAX ? PDB_PACKED_MAX : extra;
+			packedGroup->extras[index / 4] |= extra << 2 * (index % 4);
+		}
+	}
+	freePatternDatabase(pdb);
+	free(pdb);
+}
+
+void freePackedDatabase(PackedDatabase *packed) {
+	for (int i = 0; i < packed->groupCount; i++) {
+		if (packed->groups[i].owner == i) {
+			free(packed->groups[i].extras);
+		}
+	}
+	free(packed->manhattan);
+	packed->manhattan = NULL;
+	packed->groupCount = 0;
+}
+
+int lookupPacked(const PackedDatabase *packed, const Board *board) {
+	const int n = board->rows * board->cols;
+	unsigned char positions[MAX_CELLS];
+	for (int i = 0; i < n; i++) {
+		positions[board->cells[i]] = i;
+	}
+	int distance = 0;
+	int extras = 0;
+	for (int g = 0; g < packed->groupCount; g++) {
+		const PackedGroup *group = &packed->groups[g];
+		const unsigned char *cells = packed->cellMaps[group->owner != g];
+		uint32_t index = 0;
+		for (int i = group->size - 1; i >= 0; i--) {
+			const int tile = group->tiles[i];
+			index = index * n + cells[positions[tile]];
+			distance += packed->manhattan[tile * n + positions[tile]];
+		}
+		extras += group->extras[index / 4] >> 2 * (index % 4) & 3;
+	}
+	return distance + 2 * extras;
+}
+
+// the packed database for the last board size asked for, built the first time it's needed
+// like patternDatabase, the first call for a size has to come before any threads use it
+PackedDatabase *packedDatabase(int rows, int cols) {
+	static PackedDatabase *packed = NULL;
+	if (packed == NULL) {
+		packed = calloc(1, sizeof(PackedDatabase));
+	}
+	if (packed->rows != rows || packed->cols != cols) {
+		freePackedDatabase(packed);
+		buildPackedDatabase(packed, rows, cols, patternThreads());
+	}
+	return packed;
+}
+
+int packedEstimate(const Board *board) {
+	const int patterns = lookupPacked(packedDatabase(board->rows, board->cols), board);
+	const int conflict = linearConflict(board);
+	return patterns > conflict ? patterns : conflict;
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "board.h"
+#include "ranking.h"
+
+// perimeter search: every board within depth moves of the goal, with its distance
+// http://dx.doi.org/10.1016/0004-3702(94)90068-X
+//
+// every instance has the same goal, so the boards around it are found once by a breadth first
+// search and written to a file: an open addressed table of solvable ranks + 1 (0 is empty)
+// followed by a distance byte per slot. searches map the file read only, so any number of
+// processes solving at once share one copy in the page cache.
+// a search that reaches a board in the perimeter knows exactly how far it is from the goal and
+// can walk the rest of the way down the distances. any board outside is more than depth away,
+// which is often more than the heuristic says near the goal.
+// on a square board a board and its reflection in the main diagonal (transposeBoard) are as far
+// from the goal, so both are keyed by the lesser of their ranks and the file holds about half as many
+
+#define PERIMETER_MAGIC "NPZP"
+#define PERIMETER_OUTSIDE -1
+
+typedef struct PerimeterHeader {
+	char magic[4];
+	int rows;
+	int cols;
+	int depth;
+	uint64_t count;
+	uint64_t slots; // a power of 2
+} PerimeterHeader;
+
+typedef struct Perimeter {
+	PerimeterHeader header;
+	const uint64_t *keys;
+	const unsigned char *distances;
+	void *map;
+	size_t mapBytes;
+} Perimeter;
+
+static inline uint64_t perimeterHash(uint64_t key) {
+	key = (key ^ key >> 31) * 0x7fb5d329728ea185;
+	key = (key ^ key >> 27) * 0x81dadef4bc2dd44d;
+	return key ^ key >> 33;
+}
+
+static inline size_t perimeterBytes(uint64_t slots) {
+	return sizeof(PerimeterHeader) + slots * (sizeof(uint64_t) + 1);
+}
+
+static uint64_t perimeterKey(const Board *board) {
+	const uint64_t rank = rankSolvable(board);
+	if (board->rows != board->cols) {
+		return rank;
+	}
+	Board reflected;
+	transposeBoard(board, &reflected);
+	const uint64_t reflectedRank = rankSolvable(&reflected);
+	return reflectedRank < rank ? reflectedRank : rank;
+}
+
+// returns the slot rank is in, or the empty slot it would go in
+static uint64_t perimeterSlot(const uint64_t *keys, uint64_t mask, uint64_t rank) {
+	uint64_t i = perimeterHash(rank) & mask;
+	while (keys[i] && keys[i] != rank + 1) {
+		i = (i + 1) & mask;
+	}
+	return i;
+}
+
+// breadth first search from the goal out to depth, written to path
+// written under a temporary name and renamed, so a process opening path never sees half of it
+// returns false with errno set if the file couldn't be written
+bool buildPerimeter(const char *path, int rows, int cols, int depth) {
+	// a growing set of every board found so far, and the boards in the order they were found
+	uint64_t mask = (1 << 12) - 1;
+	uint64_t *found = calloc(mask + 1, sizeof(uint64_t));
+	uint64_t count = 0;
+	uint64_t capacity = 1 << 10;
+	uint64_t *order = malloc(capacity * sizeof(uint64_t));
+	unsigned char *orderDistances = malloc(capacity);
+
+	Board board;
+	goalBoard(&board, rows, cols);
+	order[count] = perimeterKey(&board);
+	orderDistances[count++] = 0;
+	found[perimeterSlot(found, mask, order[0])] = order[0] + 1;
+	for (uint64_t layerStart = 0, layerEnd = 1, distance = 1; distance <= depth; distance++) {
+		for (uint64_t i = layerStart; i < layerEnd; i++) {
+			unrankSolvable(order[i], rows, cols, &board);
+			for (int move = 0; move < 4; move++) {
+				if (!canMove(&board, move)) {
+					continue;
+				}
+				applyMove(&board, move);
+				const uint64_t rank = perimeterKey(&board);
+				const uint64_t slot = perimeterSlot(found, mask, rank);
+				if (!found[slot]) {
+					found[slot] = rank + 1;
+					if (count == capacity) {
+						capacity *= 2;
+						order = realloc(order, capacity * sizeof(uint64_t));
+						orderDistances = realloc(orderDistances, capacity);
+					}
+					order[count] = rank;
+					orderDistances[count++] = distance;
+					// keep it at most half full
+					if (2 * count > mask) {
+						free(found);
+						mask = mask * 2 + 1;
+						found = calloc(mask + 1, sizeof(uint64_t));
+						for (uint64_t j = 0; j < count; j++) {
+							found[perimeterSlot(found, mask, order[j])] = order[j] + 1;
+						}
+					}
+				}
+				applyMove(&board, OPPOSITE_MOVE(move));
+			}
+		}
+		layerStart = layerEnd;
+		layerEnd = count;
+	}
+	free(found);
+
+	PerimeterHeader header = {PERIMETER_MAGIC, rows, cols, depth, count, 1};
+	while (header.slots < 2 * count) {
+		header.slots *= 2;
+	}
+	char temporary[4096];
+	snprintf(temporary, sizeof(temporary), "%s.%i", path, getpid());
+	const size_t bytes = perimeterBytes(header.slots);
+	const int fd = open(temporary, O_RDWR | O_CREAT | O_TRUNC, 0644);
+	bool written = fd >= 0 && !ftruncate(fd, bytes);
+	unsigned char *map = written ? mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+	written = map != MAP_FAILED;
+	if (written) {
+		memcpy(map, &header, sizeof(header));
+		uint64_t *keys = (uint64_t *)(map + sizeof(header));
+		unsigned char *distances = (unsigned char *)(keys + header.slots);
+		for (uint64_t i = 0; i < count; i++) {
+			const uint64_t slot = perimeterSlot(keys, header.slots - 1, order[i]);
+			keys[slot] = order[i] + 1;
+			distances[slot] = orderDistances[i];
+		}
+		written = !munmap(map, bytes) && !fsync(fd);
+	}
+	if (fd >= 0) {
+		close(fd);
+	}
+	written = written && !rename(temporary, path);
+	if (!written) {
+		unlink(temporary);
+	}
+	free(order);
+	free(orderDistances);
+	return written;
+}
+
+// maps the perimeter at path, returns false if it can't be read or isn't one
+bool openPerimeter(Perimeter *perimeter, const char *path) {
+	memset(perimeter, 0, sizeof(Perimeter));
+	const int fd = open(path, O_RDONLY);
+	if (fd < 0) {
+		return false;
+	}
+	struct stat st;
+	PerimeterHeader header;
+	if (fstat(fd, &st) || read(fd, &header, sizeof(header)) != sizeof(header)
+			|| memcmp(header.magic, PERIMETER_MAGIC, 4) || header.slots & (header.slots - 1)
+			|| st.st_size != perimeterBytes(header.slots)) {
+		close(fd);
+		return false;
+	}
+	void *map = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) {
+		return false;
+	}
+	perimeter->header = header;
+	perimeter->map = map;
+	perimeter->mapBytes = st.st_size;
+	perimeter->keys = (const uint64_t *)((unsigned char *)map + sizeof(header));
+	perimeter->distances = (const unsigned char *)(perimeter->keys + header.slots);
+	return true;
+}
+
+void closePerimeter(Perimeter *perimeter) {
+	if (perimeter->map != NULL) {
+		munmap(perimeter->map, perimeter->mapBytes);
+	}
+	memset(perimeter, 0, sizeof(Perimeter));
+}
+
+// how far board is from the goal, or PERIMETER_OUTSIDE if it's further than the depth
+int perimeterDistance(const Perimeter *perimeter, const Board *board) {
+	const uint64_t slot = perimeterSlot(perimeter->keys, perimeter->header.slots - 1, perimeterKey(board));
+	return perimeter->keys[slot] ? perimeter->distances[slot] : PERIMETER_OUTSIDE;
+}
+
+// the least a board outside can be from the goal: more than the depth,
+// and every solution has the parity of the 0's distance from home
+int perimeterOutside(const Perimeter *perimeter, const Board *board) {
+	const int parity = (board->blank / board->cols + board->blank % board->cols) & 1;
+	const int least = perimeter->header.depth + 1;
+	return least + ((least ^ parity) & 1);
+}
+
+// writes the distance moves from board, which is that far in the perimeter, to the goal
+void perimeterPath(const Perimeter *perimeter, const Board *start, int distance, char *moves) {
+	Board board = *start;
+	for (int i = 0; i < distance; i++) {
+		for (int move = 0; move < 4; move++) {
+			if (canMove(&board, move)) {
+				applyMove(&board, move);
+				if (perimeterDistance(perimeter, &board) == distance - i - 1) {
+					moves[i] = moveChars[move];
+					break;
+				}
+				applyMove(&board, OPPOSITE_MOVE(move));
+			}
+		}
+	}
+}
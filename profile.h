@@ -0,0 +1,178 @@
+#pragma once
+
+// per phase counters and timers for the solvers
+//
+// built in with -DPROFILE, otherwise every macro here compiles to nothing
+// moves and time are charged to the innermost phase running at the time, so time spent
+// in positionFromRight called from moveAToB counts for positionFromRight only.
+// searches count their runs and the nodes expanded in each iteration of each run
+// everything is written as json to $PROFILE_OUT, or profile.json, when the program exits
+
+typedef enum PHASE {
+	PHASE_OTHER,
+	PHASE_MOVE_A_TO_B,
+	PHASE_FROM_RIGHT,
+	PHASE_FROM_BOTTOM,
+	PHASE_FROM_TOP,
+	PHASE_MACRO,
+	PHASE_SECOND_LAST,
+	PHASE_PAIR_ENDGAME, // the last 2 cells of a column, from endgame_table.h
+	PHASE_FINAL_ROTATION, // the last 2 cells of a column, from their pre positions
+	PHASE_FINAL_SQUARE, // the 2x2 left at the end
+	PHASE_COUNT
+} PHASE;
+
+typedef enum SEARCH {
+	SEARCH_BIDIRECTIONAL,
+	SEARCH_WEIGHTED,
+	SEARCH_COUNT
+} SEARCH;
+
+#ifdef PROFILE
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define PROFILE_MAX_ITERATIONS 128 // later iterations are counted in the last one
+
+const char *phaseNames[PHASE_COUNT] = {
+	"other", "moveAToB", "positionFromRight", "positionFromBottom", "positionFromTop",
+	"macroAToB", "secondLastToPrePos", "pairEndgame", "finalRotation", "finalSquare"
+};
+const char *searchNames[SEARCH_COUNT] = {"bidir", "astar"};
+
+typedef struct PhaseProfile {
+	long calls;
+	long moves;
+	int64_t ns; // not counting phases entered from this one
+} PhaseProfile;
+
+typedef struct SearchProfile {
+	long runs;
+	int64_t ns;
+	long iterations[PROFILE_MAX_ITERATIONS]; // how many runs got to each iteration
+	long nodes[PROFILE_MAX_ITERATIONS]; // nodes expanded in each iteration over all runs
+} SearchProfile;
+
+typedef struct Profile {
+	PhaseProfile phases[PHASE_COUNT];
+	SearchProfile searches[SEARCH_COUNT];
+	int phase;
+	int64_t since; // when the current phase's clock last started
+	bool started;
+} Profile;
+
+Profile profile;
+
+static inline int64_t profileNs() {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec * (int64_t)1000000000 + t.tv_nsec;
+}
+
+void writeProfile(FILE *f) {
+	fprintf(f, "{\n\t\"phases\": {");
+	for (int i = 0; i < PHASE_COUNT; i++) {
+		const PhaseProfile *p = &profile.phases[i];
+		fprintf(f, "%s\n\t\t\"%s\": {\"calls\": %li, \"moves\": %li, \"ns\": %lli}", i ? "," : "",
+				phaseNames[i], p->calls, p->moves, (long long)p->ns);
+	}
+	fprintf(f, "\n\t},\n\t\"searches\": {");
+	for (int i = 0; i < SEARCH_COUNT; i++) {
+		const SearchProfile *s = &profile.searches[i];
+		fprintf(f, "%s\n\t\t\"%s\": {\"runs\": %li, \"ns\": %lli, \"iterations\": [", i ? "," : "",
+				searchNames[i], s->runs, (long long)s->ns);
+		for (int j = 0; j < PROFILE_MAX_ITERATIONS && s->iterations[j]; j++) {
+			fprintf(f, "%s{\"runs\": %li, \"nodes\": %li}", j ? ", " : "", s->iterations[j], s->nodes[j]);
+		}
+		fprintf(f, "]}");
+	}
+	fprintf(f, "\n\t}\n}\n");
+}
+
+static void writeProfileAtExit() {
+	const char *path = getenv("PROFILE_OUT");
+	FILE *f = fopen(path != NULL ? path : "profile.json", "w");
+	if (f != NULL) {
+		writeProfile(f);
+		fclose(f);
+	}
+}
+
+static inline void startProfile() {
+	if (!profile.started) {
+		profile.started = true;
+		profile.since = profileNs();
+		atexit(&writeProfileAtExit);
+	}
+}
+
+// stops the clock of the current phase and starts phase's
+// returns the phase to go back to
+static inline int enterPhase(int phase) {
+	startProfile();
+	const int64_t now = profileNs();
+	profile.phases[profile.phase].ns += now - profile.since;
+	profile.since = now;
+	profile.phases[phase].calls++;
+	const int previous = profile.phase;
+	profile.phase = phase;
+	return previous;
+}
+
+static inline void leavePhase(int *previous) {
+	const int64_t now = profileNs();
+	profile.phases[profile.phase].ns += now - profile.since;
+	profile.since = now;
+	profile.phase = *previous;
+}
+
+typedef struct SearchScope {
+	int search;
+	int64_t start;
+} SearchScope;
+
+static inline SearchScope enterSearch(int search) {
+	startProfile();
+	profile.searches[search].runs++;
+	return (SearchScope){search, profileNs()};
+}
+
+static inline void leaveSearch(SearchScope *scope) {
+	profile.searches[scope->search].ns += profileNs() - scope->start;
+}
+
+static inline void countIteration(int search, int iteration, long nodes) {
+	SearchProfile *s = &profile.searches[search];
+	iteration = iteration < PROFILE_MAX_ITERATIONS ? iteration : PROFILE_MAX_ITERATIONS - 1;
+	s->iterations[iteration]++;
+	s->nodes[iteration] += nodes;
+}
+
+// the phase lasts until the end of the enclosing block, however it's left
+#define PROFILE_PHASE(phase) \
+	int profiledPhase __attribute__((cleanup(leavePhase))) = enterPhase(phase)
+#define PROFILE_SEARCH(search) \
+	SearchScope profiledSearch __attribute__((cleanup(leaveSearch))) = enterSearch(search)
+#define PROFILE_ITERATION(search, iteration, nodes) countIteration((search), (iteration), (nodes))
+#define PROFILE_MOVE() profile.phases[profile.phase].moves++
+// for after a longjmp skipped leaving the phases it jumped out of
+#define PROFILE_RESET_PHASE() \
+do { \
+	if (profile.started) { \
+		leavePhase(&(int){PHASE_OTHER}); \
+	} \
+} while (false)
+
+#else
+
+#define PROFILE_PHASE(phase)
+#define PROFILE_SEARCH(search)
+#define PROFILE_ITERATION(search, iteration, nodes)
+#define PROFILE_MOVE()
+#define PROFILE_RESET_PHASE()
+
+#endif
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "board.h"
+#include "ranking.h"
+
+// uniformly random solvable boards, without drawing anything
+//
+// up to MAX_RANK_CELLS cells a board is a random rank in the solvable half unranked straight
+// in to place. the rank is never made: its factorial base digits are independent and uniform,
+// so each digit is drawn on its own, which needs no division.
+// past that the ranks don't fit in 64 bits, so the cells are shuffled instead,
+// keeping track of the parity as they go, and if it comes out wrong 2 tiles next to the 0
+// are swapped. that swap pairs every unsolvable board with exactly one solvable board,
+// so the result is still uniform
+//
+// everything takes the state of an xorshift generator, which must not be 0
+
+#define RANDOM_BATCH 64 // boards generate.c asks randomSolvableBoards for at once
+
+static inline uint64_t nextRandom(uint64_t *state) {
+	*state ^= *state >> 12;
+	*state ^= *state << 25;
+	*state ^= *state >> 27;
+	return *state * 0x2545f4914f6cdd1d;
+}
+
+// uniform from 0 to bound - 1, by multiplying and rejecting the few draws that would bias it
+// https://arxiv.org/abs/1805.10941
+static inline uint64_t randomBelow(uint64_t *state, uint64_t bound) {
+	unsigned __int128 product = (unsigned __int128)nextRandom(state) * bound;
+	if ((uint64_t)product < bound) {
+		const uint64_t threshold = -bound % bound;
+		while ((uint64_t)product < threshold) {
+			product = (unsigned __int128)nextRandom(state) * bound;
+		}
+	}
+	return product >> 64;
+}
+
+// shuffles cells in to a uniformly random solvable board and returns where the 0 is
+// defined for both cell types since the game keeps its cells as ints and can be bigger than a Board
+#define DEFINE_SHUFFLE_SOLVABLE(name, type) \
+int name(uint64_t *state, int rows, int cols, type *cells) { \
+	const int length = rows * cols; \
+	for (int i = 0; i < length; i++) { \
+		cells[i] = i; \
+	} \
+	bool parity = false; \
+	int blank = 0; \
+	for (int i = length - 1; i > 0; i--) { \
+		const int j = randomBelow(state, i + 1); \
+		if (j != i) { \
+			const type temp = cells[i]; \
+			cells[i] = cells[j]; \
+			cells[j] = temp; \
+			parity = !parity; \
+			blank = !cells[j] ? j : !cells[i] ? i : blank; \
+		} \
+	} \
+	const bool manhattanParity = (blank / cols + blank % cols) % 2; \
+	if (parity != manhattanParity) { \
+		const int a = (blank + 1) % length; \
+		const int b = (blank + 2) % length; \
+		const type temp = cells[a]; \
+		cells[a] = cells[b]; \
+		cells[b] = temp; \
+	} \
+	return blank; \
+}
+DEFINE_SHUFFLE_SOLVABLE(shuffleSolvable, unsigned char)
+DEFINE_SHUFFLE_SOLVABLE(intShuffleSolvable, int)
+
+void randomSolvableBoard(uint64_t *state, int rows, int cols, Board *board) {
+	const int length = rows * cols;
+	if (length > MAX_RANK_CELLS) {
+		board->rows = rows;
+		board->cols = cols;
+		board->blank = shuffleSolvable(state, rows, cols, board->cells);
+		return;
+	}
+	int digits[MAX_RANK_CELLS];
+	for (int i = 0; i < length - 2; i++) {
+		digits[i] = randomBelow(state, length - i);
+	}
+	solvableFromDigits(digits, rows, cols, board);
+}
+
+// fills boards with count random solvable boards
+void randomSolvableBoards(uint64_t *state, int rows, int cols, Board *boards, long count) {
+	for (long i = 0; i < count; i++) {
+		randomSolvableBoard(state, rows, cols, &boards[i]);
+	}
+}
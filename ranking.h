@@ -0,0 +1,275 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "board.h"
+
+// permutation ranking and unranking
+//
+// lexicographic ranks keep the order of the permutations, which the solvable half
+// ranking below relies on. Myrvold-Ruskey ranks are in no useful order but don't need
+// any bit tricks. partial ranks index k tiles placed among n cells and are what pattern
+// databases use.
+//
+// every function is O(n). up to 16 cells the remaining values are kept as nibbles
+// in a single word so picking the k-th one while unranking is a shift and a mask
+
+// 20! is the largest factorial that fits in 64 bits
+#define MAX_RANK_CELLS 20
+
+const uint64_t factorials[MAX_RANK_CELLS + 1] = {
+	1ull,
+	1ull,
+	2ull,
+	6ull,
+	24ull,
+	120ull,
+	720ull,
+	5040ull,
+	40320ull,
+	362880ull,
+	3628800ull,
+	39916800ull,
+	479001600ull,
+	6227020800ull,
+	87178291200ull,
+	1307674368000ull,
+	20922789888000ull,
+	355687428096000ull,
+	6402373705728000ull,
+	121645100408832000ull,
+	2432902008176640000ull
+};
+
+// 0xfedcba9876543210: nibble i holds i
+#define NIBBLE_IDENTITY 0xfedcba9876543210ull
+
+// remove nibble i from list, shifting the ones above it down
+static inline uint64_t removeNibble(uint64_t list, int i) {
+	const uint64_t below = list & ((1ull << (4 * i)) - 1);
+	const uint64_t above = i == 15 ? 0 : (list >> (4 * (i + 1))) << (4 * i);
+	return below | above;
+}
+
+// lexicographic rank of perm, a permutation of 0 to n - 1, n <= MAX_RANK_CELLS
+uint64_t rankPerm(const unsigned char *perm, int n) {
+	uint32_t used = 0;
+	uint64_t rank = 0;
+	for (int i = 0; i < n; i++) {
+		// number of smaller values that haven't been used yet
+		const int digit = perm[i] - __builtin_popcount(used & ((1u << perm[i]) - 1));
+		rank = rank * (n - i) + digit;
+		used |= 1u << perm[i];
+	}
+	return rank;
+}
+
+// the permutation whose lexicographic rank has these factorial base digits,
+// digit i being from 0 to n - i - 1, most significant first
+void permFromDigits(const int *digits, int n, unsigned char *perm) {
+	if (n <= 16) {
+		uint64_t list = NIBBLE_IDENTITY;
+		for (int i = 0; i < n; i++) {
+			perm[i] = (list >> (4 * digits[i])) & 0xf;
+			list = removeNibble(list, digits[i]);
+		}
+	}
+	else {
+		// same trick with 5 bit fields in a 128 bit word
+		unsigned __int128 list = 0;
+		for (int i = n - 1; i >= 0; i--) {
+			list = list << 5 | i;
+		}
+		for (int i = 0; i < n; i++) {
+			const int shift = 5 * digits[i];
+			perm[i] = (list >> shift) & 0x1f;
+			const unsigned __int128 below = list & (((unsigned __int128)1 << shift) - 1);
+			list = below | ((list >> (shift + 5)) << shift);
+		}
+	}
+}
+
+// inverse of rankPerm
+// returns the parity of the permutation, which falls out of the digits for free
+bool unrankPerm(uint64_t rank, int n, unsigned char *perm) {
+	int digits[MAX_RANK_CELLS];
+	bool parity = false;
+	int i = n - 1;
+	// 64 bit division is several times slower, only use it while it's needed
+	for (; rank > UINT32_MAX; i--) {
+		digits[i] = rank % (n - i);
+		rank /= n - i;
+		parity ^= digits[i] & 1;
+	}
+	for (uint32_t small = rank; i >= 0; i--) {
+		digits[i] = small % (n - i);
+		small /= n - i;
+		parity ^= digits[i] & 1;
+	}
+	permFromDigits(digits, n, perm);
+	return parity;
+}
+
+// Myrvold-Ruskey rank of perm, a permutation of 0 to n - 1
+// https://webhome.cs.uvic.ca/~ruskey/Publications/RankPerm/MyrvoldRuskey.pdf
+uint64_t rankPermMR(const unsigned char *perm, int n) {
+	unsigned char copy[MAX_RANK_CELLS];
+	unsigned char inverse[MAX_RANK_CELLS];
+	for (int i = 0; i < n; i++) {
+		copy[i] = perm[i];
+		inverse[perm[i]] = i;
+	}
+
+	int digits[MAX_RANK_CELLS];
+	for (int i = n; i > 1; i--) {
+		const int s = copy[i - 1];
+		digits[i - 1] = s;
+		copy[inverse[i - 1]] = s;
+		copy[i - 1] = i - 1;
+		inverse[s] = inverse[i - 1];
+		inverse[i - 1] = i - 1;
+	}
+
+	uint64_t rank = 0;
+	for (int i = 2; i <= n; i++) {
+		rank = digits[i - 1] + i * rank;
+	}
+	return rank;
+}
+
+// inverse of rankPermMR
+void unrankPermMR(uint64_t rank, int n, unsigned char *perm) {
+	for (int i = 0; i < n; i++) {
+		perm[i] = i;
+	}
+	for (int i = n; i > 1; i--) {
+		const int j = rank % i;
+		const unsigned char temp = perm[i - 1];
+		perm[i - 1] = perm[j];
+		perm[j] = temp;
+		rank /= i;
+	}
+}
+
+// number of ways to place k tiles among n cells: n! / (n - k)!
+uint64_t partialCount(int n, int k) {
+	uint64_t count = 1;
+	for (int i = 0; i < k; i++) {
+		count *= n - i;
+	}
+	return count;
+}
+
+// lexicographic rank of positions, k distinct cells out of n <= 64
+uint64_t rankPartial(const unsigned char *positions, int k, int n) {
+	uint64_t used = 0;
+	uint64_t rank = 0;
+	for (int i = 0; i < k; i++) {
+		const int digit = positions[i] - __builtin_popcountll(used & ((1ull << positions[i]) - 1));
+		rank = rank * (n - i) + digit;
+		used |= 1ull << positions[i];
+	}
+	return rank;
+}
+
+// inverse of rankPartial
+void unrankPartial(uint64_t rank, int k, int n, unsigned char *positions) {
+	int digits[64];
+	int i = k - 1;
+	for (; rank > UINT32_MAX; i--) {
+		digits[i] = rank % (n - i);
+		rank /= n - i;
+	}
+	for (uint32_t small = rank; i >= 0; i--) {
+		digits[i] = small % (n - i);
+		small /= n - i;
+	}
+
+	if (n <= 16) {
+		uint64_t list = NIBBLE_IDENTITY;
+		for (i = 0; i < k; i++) {
+			positions[i] = (list >> (4 * digits[i])) & 0xf;
+			list = removeNibble(list, digits[i]);
+		}
+	}
+	else {
+		uint64_t open = n == 64 ? ~0ull : (1ull << n) - 1;
+		for (i = 0; i < k; i++) {
+			// select the digits[i]-th open cell
+			uint64_t bits = open;
+			for (int skip = digits[i]; skip; skip--) {
+				bits &= bits - 1;
+			}
+			positions[i] = __builtin_ctzll(bits);
+			open &= ~(1ull << positions[i]);
+		}
+	}
+}
+
+// ranks of the solvable half of the boards, from 0 to n! / 2 - 1
+//
+// these rank where each tile is rather than what is in each cell. swapping where the
+// last 2 tiles are flips solvability, and in lexicographic order that swap only changes
+// the lowest bit of the rank. so rank / 2 is a perfect hash of the solvable boards
+
+uint64_t solvableCount(int rows, int cols) {
+	return factorials[rows * cols] / 2;
+}
+
+uint64_t rankSolvable(const Board *board) {
+	const int length = board->rows * board->cols;
+	unsigned char positions[MAX_RANK_CELLS];
+	for (int i = 0; i < length; i++) {
+		positions[board->cells[i]] = i;
+	}
+	return rankPerm(positions, length) / 2;
+}
+
+// the solvable board with these factorial base digits, see permFromDigits
+// the last 2 digits are ignored, they're the bit rankSolvable drops and a digit that's always 0
+void solvableFromDigits(int *digits, int rows, int cols, Board *board) {
+	const int length = rows * cols;
+	digits[length - 2] = 0;
+	digits[length - 1] = 0;
+	bool parity = false;
+	for (int i = 0; i < length - 2; i++) {
+		parity ^= digits[i] & 1;
+	}
+	unsigned char positions[MAX_RANK_CELLS];
+	permFromDigits(digits, length, positions);
+
+	// solvable when the parity of the permutation matches the parity of
+	// the manhattan distance of 0 to its goal position
+	const bool manhattanParity = (positions[0] / cols + positions[0] % cols) % 2;
+	if (parity != manhattanParity) {
+		const unsigned char temp = positions[length - 2];
+		positions[length - 2] = positions[length - 1];
+		positions[length - 1] = temp;
+	}
+
+	board->rows = rows;
+	board->cols = cols;
+	board->blank = positions[0];
+	for (int i = 0; i < length; i++) {
+		board->cells[positions[i]] = i;
+	}
+}
+
+void unrankSolvable(uint64_t rank, int rows, int cols, Board *board) {
+	const int length = rows * cols;
+	int digits[MAX_RANK_CELLS];
+	// the digits of 2 * rank
+	digits[length - 2] = 0;
+	digits[length - 1] = 0;
+	int i = length - 3;
+	for (; rank > UINT32_MAX; i--) {
+		digits[i] = rank % (length - i);
+		rank /= length - i;
+	}
+	for (uint32_t small = rank; i >= 0; i--) {
+		digits[i] = small % (length - i);
+		small /= length - i;
+	}
+	solvableFromDigits(digits, rows, cols, board);
+}
@@ -0,0 +1,455 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "ranking.h"
+
+// (board, solution) records, in a compact binary format and a text format
+//
+// binary layout, all integers little endian:
+// 	header:
+// 		"NPZB"
+// 		u8  version
+// 		u8  rows
+// 		u8  cols
+// 		u8  algorithm that produced the solutions (ALGORITHM_NONE for bare instances)
+// 		u8  board encoding
+// 		u8  flags
+// 		u8  reserved[2]
+// 		i64 seed
+// 	records, until end of file:
+// 		board, encoded as given by the header
+// 		varint (moveCount << 1 | runLength), absent when algorithm is ALGORITHM_NONE
+// 		moves:
+// 			runLength == 0: 2 bits per move, 4 moves per byte, first move in the low bits
+// 			runLength == 1: 1 byte per run, move in the low 2 bits and (run length - 1) above
+//
+// text layout:
+// 	npuzzle <rows> <cols> <algorithm> <seed>
+// 	one line per record: the cells in row major order, then the moves as a DOMOVES string
+// 	("-" for an empty solution, nothing when algorithm is none)
+
+#define RECORD_MAGIC "NPZB"
+#define RECORD_VERSION 1
+#define RECORD_HEADER_SIZE 20
+
+// each cell gets as many bits as the largest value needs
+// so boards up to 16 cells are nibble packed
+#define BOARD_PACKED 0
+// lexicographic rank of the cells in as few bytes as n! needs, up to MAX_RANK_CELLS cells
+#define BOARD_RANKED 1
+
+// allow run length encoded solutions; the writer picks whichever is smaller per record
+#define RECORD_RLE 1
+
+#define MAX_RUN 64
+
+enum {
+	ALGORITHM_NONE,
+	ALGORITHM_GREEDY,
+	ALGORITHM_TABLE,
+	ALGORITHM_BIDIRECTIONAL,
+	ALGORITHM_WEIGHTED,
+	ALGORITHM_ANYTIME,
+	ALGORITHM_PARALLEL,
+	ALGORITHM_MEMORY_BOUNDED,
+	ALGORITHM_FRONTIER,
+	ALGORITHM_IDA,
+	ALGORITHM_COUNT
+};
+
+const char *algorithmNames[ALGORITHM_COUNT] = {
+	"none",
+	"greedy",
+	"table",
+	"bidir",
+	"astar",
+	"anytime",
+	"hda",
+	"sma",
+	"frontier",
+	"ida"
+};
+
+typedef struct RecordHeader {
+	int rows;
+	int cols;
+	int algorithm;
+	int encoding;
+	int flags;
+	long seed;
+} RecordHeader;
+
+typedef struct Record {
+	Board board;
+	char *moves; // DOMOVES string, not null terminated
+	int moveCount;
+	int capacity;
+} Record;
+
+// longest solution a record may hold, anything longer is taken as corrupt
+#define MAX_RECORD_MOVES (64 * MAX_CELLS)
+
+enum {
+	RECORD_CORRUPT = -1,
+	RECORD_EOF,
+	RECORD_OK
+};
+
+// returns the algorithm with the given name, or -1 if there isn't one
+int algorithmFromName(const char *name) {
+	for (int i = 0; i < ALGORITHM_COUNT; i++) {
+		if (!strcmp(name, algorithmNames[i])) {
+			return i;
+		}
+	}
+	return -1;
+}
+
+// number of bits needed to store every value from 0 to length - 1
+int bitsPerCell(int length) {
+	int bits = 1;
+	while ((1 << bits) < length) {
+		bits++;
+	}
+	return bits;
+}
+
+int boardBytes(const RecordHeader *header) {
+	const int length = header->rows * header->cols;
+	if (header->encoding == BOARD_RANKED) {
+		return (64 - __builtin_clzll(factorials[length] - 1) + 7) / 8;
+	}
+	return (length * bitsPerCell(length) + 7) / 8;
+}
+
+// checks that every value appears exactly once and finds the 0
+bool validateBoard(Board *board) {
+	const int length = board->rows * board->cols;
+	bool seen[MAX_CELLS] = {false};
+	for (int i = 0; i < length; i++) {
+		const int v = board->cells[i];
+		if (v >= length || seen[v]) {
+			return false;
+		}
+		seen[v] = true;
+		if (!v) {
+			board->blank = i;
+		}
+	}
+	return true;
+}
+
+void packBoard(const Board *board, unsigned char *out) {
+	const int length = board->rows * board->cols;
+	const int bits = bitsPerCell(length);
+	memset(out, 0, (length * bits + 7) / 8);
+	for (int i = 0, bit = 0; i < length; i++, bit += bits) {
+		// a cell can straddle at most 2 bytes since bits <= 8
+		const int v = board->cells[i] << (bit % 8);
+		out[bit / 8] |= v;
+		if (bit % 8 + bits > 8) {
+			out[bit / 8 + 1] |= v >> 8;
+		}
+	}
+}
+
+void unpackBoard(const unsigned char *in, Board *board) {
+	const int length = board->rows * board->cols;
+	const int bits = bitsPerCell(length);
+	for (int i = 0, bit = 0; i < length; i++, bit += bits) {
+		int v = in[bit / 8] >> (bit % 8);
+		if (bit % 8 + bits > 8) {
+			v |= in[bit / 8 + 1] << (8 - bit % 8);
+		}
+		board->cells[i] = v & ((1 << bits) - 1);
+	}
+}
+
+static void putLittleEndian(unsigned char *out, uint64_t v, int bytes) {
+	for (int i = 0; i < bytes; i++) {
+		out[i] = v >> (8 * i);
+	}
+}
+
+static uint64_t getLittleEndian(const unsigned char *in, int bytes) {
+	uint64_t v = 0;
+	for (int i = 0; i < bytes; i++) {
+		v |= (uint64_t)in[i] << (8 * i);
+	}
+	return v;
+}
+
+bool validEncoding(const RecordHeader *header) {
+	switch (header->encoding) {
+		case BOARD_PACKED:
+			return true;
+		case BOARD_RANKED:
+			return header->rows * header->cols <= MAX_RANK_CELLS;
+	}
+	return false;
+}
+
+void encodeBoard(const RecordHeader *header, const Board *board, unsigned char *out) {
+	if (header->encoding == BOARD_RANKED) {
+		putLittleEndian(out, rankPerm(board->cells, board->rows * board->cols), boardBytes(header));
+	}
+	else {
+		packBoard(board, out);
+	}
+}
+
+// returns false if the encoded board is out of range
+bool decodeBoard(const RecordHeader *header, const unsigned char *in, Board *board) {
+	board->rows = header->rows;
+	board->cols = header->cols;
+	if (header->encoding == BOARD_RANKED) {
+		const uint64_t rank = getLittleEndian(in, boardBytes(header));
+		if (rank >= factorials[board->rows * board->cols]) {
+			return false;
+		}
+		unrankPerm(rank, board->rows * board->cols, board->cells);
+	}
+	else {
+		unpackBoard(in, board);
+	}
+	return validateBoard(board);
+}
+
+bool writeRecordHeader(FILE *f, const RecordHeader *header) {
+	unsigned char out[RECORD_HEADER_SIZE] = {0};
+	memcpy(out, RECORD_MAGIC, 4);
+	out[4] = RECORD_VERSION;
+	out[5] = header->rows;
+	out[6] = header->cols;
+	out[7] = header->algorithm;
+	out[8] = header->encoding;
+	out[9] = header->flags;
+	putLittleEndian(out + 12, header->seed, 8);
+	return fwrite(out, RECORD_HEADER_SIZE, 1, f) == 1;
+}
+
+bool readRecordHeader(FILE *f, RecordHeader *header) {
+	unsigned char in[RECORD_HEADER_SIZE];
+	if (fread(in, RECORD_HEADER_SIZE, 1, f) != 1 || memcmp(in, RECORD_MAGIC, 4) || in[4] != RECORD_VERSION) {
+		return false;
+	}
+	header->rows = in[5];
+	header->cols = in[6];
+	header->algorithm = in[7];
+	header->encoding = in[8];
+	header->flags = in[9];
+	header->seed = getLittleEndian(in + 12, 8);
+	return header->rows >= 2 && header->cols >= 2 && header->rows * header->cols <= MAX_CELLS
+		&& header->algorithm < ALGORITHM_COUNT && validEncoding(header);
+}
+
+static void putVarint(FILE *f, uint64_t v) {
+	while (v >= 0x80) {
+		putc((v & 0x7f) | 0x80, f);
+		v >>= 7;
+	}
+	putc(v, f);
+}
+
+static bool getVarint(FILE *f, uint64_t *v) {
+	*v = 0;
+	for (int shift = 0; shift < 64; shift += 7) {
+		const int c = getc(f);
+		if (c == EOF) {
+			return false;
+		}
+		*v |= (uint64_t)(c & 0x7f) << shift;
+		if (!(c & 0x80)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+// number of bytes moves take up when run length encoded
+int runLengthBytes(const char *moves, int moveCount) {
+	int runs = 0;
+	for (int i = 0; i < moveCount; runs++) {
+		const int start = i;
+		while (i < moveCount && moves[i] == moves[start] && i - start < MAX_RUN) {
+			i++;
+		}
+	}
+	return runs;
+}
+
+bool writeRecord(FILE *f, const RecordHeader *header, const Board *board, const char *moves, int moveCount) {
+	unsigned char packed[MAX_CELLS];
+	encodeBoard(header, board, packed);
+	fwrite(packed, boardBytes(header), 1, f);
+	if (header->algorithm == ALGORITHM_NONE) {
+		return !ferror(f);
+	}
+
+	const bool runLength = (header->flags & RECORD_RLE) && runLengthBytes(moves, moveCount) < (moveCount + 3) / 4;
+	putVarint(f, (uint64_t)moveCount << 1 | runLength);
+	if (runLength) {
+		for (int i = 0; i < moveCount;) {
+			const int start = i;
+			while (i < moveCount && moves[i] == moves[start] && i - start < MAX_RUN) {
+				i++;
+			}
+			putc(moveFromChar(moves[start]) | (i - start - 1) << 2, f);
+		}
+	}
+	else {
+		for (int i = 0; i < moveCount; i += 4) {
+			int byte = 0;
+			for (int j = 0; j < 4 && i + j < moveCount; j++) {
+				byte |= moveFromChar(moves[i + j]) << (2 * j);
+			}
+			putc(byte, f);
+		}
+	}
+	return !ferror(f);
+}
+
+// make sure record->moves can hold moveCount moves, false if it can't
+bool reserveMoves(Record *record, int moveCount) {
+	if (moveCount > MAX_RECORD_MOVES) {
+		return false;
+	}
+	if (record->capacity < moveCount) {
+		const int capacity = moveCount > 2 * record->capacity ? moveCount : 2 * record->capacity;
+		char *moves = realloc(record->moves, capacity);
+		if (moves == NULL) {
+			return false;
+		}
+		record->moves = moves;
+		record->capacity = capacity;
+	}
+	return true;
+}
+
+void freeRecord(Record *record) {
+	free(record->moves);
+	record->moves = NULL;
+	record->capacity = 0;
+}
+
+// returns RECORD_OK, RECORD_EOF at a clean end of file, or RECORD_CORRUPT
+int readRecord(FILE *f, const RecordHeader *header, Record *record) {
+	unsigned char packed[MAX_CELLS];
+	const size_t bytes = boardBytes(header);
+	const size_t got = fread(packed, 1, bytes, f);
+	if (got != bytes) {
+		return got ? RECORD_CORRUPT : RECORD_EOF;
+	}
+	if (!decodeBoard(header, packed, &record->board)) {
+		return RECORD_CORRUPT;
+	}
+	record->moveCount = 0;
+	if (header->algorithm == ALGORITHM_NONE) {
+		return RECORD_OK;
+	}
+
+	uint64_t v;
+	if (!getVarint(f, &v) || (v >> 1) > MAX_RECORD_MOVES) {
+		return RECORD_CORRUPT;
+	}
+	const int moveCount = v >> 1;
+	if (!reserveMoves(record, moveCount)) {
+		return RECORD_CORRUPT;
+	}
+	if (v & 1) {
+		while (record->moveCount < moveCount) {
+			const int c = getc(f);
+			const int run = (c >> 2) + 1;
+			if (c == EOF || record->moveCount + run > moveCount) {
+				return RECORD_CORRUPT;
+			}
+			memset(record->moves + record->moveCount, moveChars[c & 3], run);
+			record->moveCount += run;
+		}
+	}
+	else {
+		int byte = 0;
+		for (; record->moveCount < moveCount; record->moveCount++) {
+			if (!(record->moveCount % 4) && (byte = getc(f)) == EOF) {
+				return RECORD_CORRUPT;
+			}
+			record->moves[record->moveCount] = moveChars[(byte >> (2 * (record->moveCount % 4))) & 3];
+		}
+	}
+	return RECORD_OK;
+}
+
+bool writeTextHeader(FILE *f, const RecordHeader *header) {
+	return fprintf(f, "npuzzle %i %i %s %li\n", header->rows, header->cols, algorithmNames[header->algorithm], header->seed) > 0;
+}
+
+bool readTextHeader(FILE *f, RecordHeader *header) {
+	char name[32];
+	if (fscanf(f, " npuzzle %d %d %31s %ld", &header->rows, &header->cols, name, &header->seed) != 4) {
+		return false;
+	}
+	header->algorithm = algorithmFromName(name);
+	header->encoding = BOARD_PACKED;
+	header->flags = 0;
+	return header->rows >= 2 && header->cols >= 2 && header->rows * header->cols <= MAX_CELLS && header->algorithm >= 0;
+}
+
+bool writeTextRecord(FILE *f, const RecordHeader *header, const Board *board, const char *moves, int moveCount) {
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		fprintf(f, i ? " %i" : "%i", board->cells[i]);
+	}
+	if (header->algorithm != ALGORITHM_NONE) {
+		if (moveCount) {
+			fprintf(f, " %.*s", moveCount, moves);
+		}
+		else {
+			fputs(" -", f);
+		}
+	}
+	putc('\n', f);
+	return !ferror(f);
+}
+
+// returns RECORD_OK, RECORD_EOF at a clean end of file, or RECORD_CORRUPT
+int readTextRecord(FILE *f, const RecordHeader *header, Record *record) {
+	record->board.rows = header->rows;
+	record->board.cols = header->cols;
+	for (int i = 0; i < header->rows * header->cols; i++) {
+		int v;
+		const int got = fscanf(f, "%d", &v);
+		if (got != 1) {
+			return !i && got == EOF ? RECORD_EOF : RECORD_CORRUPT;
+		}
+		if (v < 0 || v >= header->rows * header->cols) {
+			return RECORD_CORRUPT;
+		}
+		record->board.cells[i] = v;
+	}
+	if (!validateBoard(&record->board)) {
+		return RECORD_CORRUPT;
+	}
+	record->moveCount = 0;
+	if (header->algorithm == ALGORITHM_NONE) {
+		return RECORD_OK;
+	}
+
+	int c;
+	while ((c = getc(f)) == ' ' || c == '\t');
+	if (c == '-') {
+		return RECORD_OK;
+	}
+	for (; moveFromChar(c) >= 0; c = getc(f)) {
+		if (!reserveMoves(record, record->moveCount + 1)) {
+			return RECORD_CORRUPT;
+		}
+		record->moves[record->moveCount++] = c;
+	}
+	ungetc(c, f);
+	return record->moveCount ? RECORD_OK : RECORD_CORRUPT;
+}
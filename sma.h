@@ -0,0 +1,369 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "heuristic.h"
+#include "astar.h"
+
+// simplified memory bounded A* (SMA*)
+// https://www.aaai.org/Papers/ECAI/1992/ECAI92-117.pdf
+//
+// A* that never keeps more than a set number of boards. boards are generated one child at a
+// time from the best one in memory (lowest f, deepest first), and when memory is full the worst
+// leaf (highest f, shallowest first) is forgotten to make room. its parent remembers the f it
+// had, so that branch is only generated again once everything else looks at least as bad, and
+// once every child of a board has been tried the board's f is backed up to the lowest of theirs.
+// a board as deep as memory is long can't lead anywhere and gets an infinite f.
+// with enough memory for the solution's path it's optimal, with less it gives up
+//
+// it's a tree search, the only duplicates dropped are moves straight back to the parent.
+// a node is about 80 bytes plus the cells, SMA_NODE_BYTES turns a budget in to boards
+
+#define SMA_INFINITY INT32_MAX
+#define SMA_OPEN 0 // heap of boards with children that can be generated, best first
+#define SMA_LEAVES 1 // heap of boards with no children in memory, worst first
+#define SMA_NODE_BYTES(n) (sizeof(SmaNode) + (n) + 2 * sizeof(int))
+
+typedef struct SmaStats {
+	long generated;
+	long regenerated; // children generated again after being forgotten
+	long forgotten; // times memory was full and a leaf had to go
+	long maxNodes;
+	long peakNodes;
+	bool stopped; // gave up because of the limit rather than running out of boards
+} SmaStats;
+
+typedef struct SmaNode {
+	int parent;
+	int g;
+	int h;
+	int f; // backed up from the children once they've all been tried
+	int key; // lowest f any child that isn't in memory could have, for SMA_OPEN
+	int children[4]; // by move, -1 when not in memory
+	int childF[4]; // by move, remembered after the child is forgotten
+	int at[2]; // position in each heap, -1 when not in it
+	unsigned char legal; // moves that can be made, except straight back
+	unsigned char tried; // moves whose child has been generated at least once
+	char move; // that got here from parent
+	bool goal;
+} SmaNode;
+
+typedef struct SmaSearch {
+	int n; // cells per board
+	SmaNode *nodes;
+	unsigned char *cells; // n per node
+	int count; // nodes ever used, some may be free
+	int capacity;
+	int maxNodes;
+	int live;
+	int freeList; // linked through parent, -1 when empty
+	int *heaps[2];
+	int heapCounts[2];
+} SmaSearch;
+
+static bool smaBefore(const SmaSearch *s, int heap, int a, int b) {
+	const SmaNode *x = &s->nodes[a];
+	const SmaNode *y = &s->nodes[b];
+	if (heap == SMA_OPEN) {
+		return x->key < y->key || (x->key == y->key && x->g > y->g);
+	}
+	return x->f > y->f || (x->f == y->f && x->g < y->g);
+}
+
+static inline void smaPlace(SmaSearch *s, int heap, int i, int node) {
+	s->heaps[heap][i] = node;
+	s->nodes[node].at[heap] = i;
+}
+
+static void smaSiftUp(SmaSearch *s, int heap, int i) {
+	const int node = s->heaps[heap][i];
+	while (i && smaBefore(s, heap, node, s->heaps[heap][(i - 1) / 2])) {
+		smaPlace(s, heap, i, s->heaps[heap][(i - 1) / 2]);
+		i = (i - 1) / 2;
+	}
+	smaPlace(s, heap, i, node);
+}
+
+static void smaSiftDown(SmaSearch *s, int heap, int i) {
+	const int node = s->heaps[heap][i];
+	const int count = s->heapCounts[heap];
+	while (2 * i + 1 < count) {
+		int child = 2 * i + 1;
+		if (child + 1 < count && smaBefore(s, heap, s->heaps[heap][child + 1], s->heaps[heap][child])) {
+			child++;
+		}
+		if (!smaBefore(s, heap, s->heaps[heap][child], node)) {
+			break;
+		}
+		smaPlace(s, heap, i, s->heaps[heap][child]);
+		i = child;
+	}
+	smaPlace(s, heap, i, node);
+}
+
+// puts node in heap, or moves it to where its key now puts it
+static void smaHeapSet(SmaSearch *s, int heap, int node) {
+	int i = s->nodes[node].at[heap];
+	if (i < 0) {
+		i = s->heapCounts[heap]++;
+		smaPlace(s, heap, i, node);
+	}
+	smaSiftUp(s, heap, i);
+	smaSiftDown(s, heap, s->nodes[node].at[heap]);
+}
+
+static void smaHeapRemove(SmaSearch *s, int heap, int node) {
+	const int i = s->nodes[node].at[heap];
+	if (i < 0) {
+		return;
+	}
+	s->nodes[node].at[heap] = -1;
+	const int last = s->heaps[heap][--s->heapCounts[heap]];
+	if (i < s->heapCounts[heap]) {
+		smaPlace(s, heap, i, last);
+		smaSiftUp(s, heap, i);
+		smaSiftDown(s, heap, s->nodes[last].at[heap]);
+	}
+}
+
+// the lowest f the child through move could have
+static inline int smaBound(const SmaNode *node, int move) {
+	const int remembered = node->tried & 1 << move ? node->childF[move] : 0;
+	return remembered > node->f ? remembered : node->f;
+}
+
+// puts node in the heaps it belongs in after anything about it changed
+static void smaRefresh(SmaSearch *s, int index) {
+	SmaNode *node = &s->nodes[index];
+	node->key = SMA_INFINITY;
+	bool leaf = true;
+	for (int move = 0; move < 4; move++) {
+		if (node->children[move] >= 0) {
+			leaf = false;
+		}
+		else if (node->legal & 1 << move) {
+			const int bound = smaBound(node, move);
+			node->key = bound < node->key ? bound : node->key;
+		}
+	}
+	if (node->key < SMA_INFINITY) {
+		smaHeapSet(s, SMA_OPEN, index);
+	}
+	else {
+		smaHeapRemove(s, SMA_OPEN, index);
+	}
+	// the root is never forgotten
+	if (leaf && node->parent >= 0) {
+		smaHeapSet(s, SMA_LEAVES, index);
+	}
+	else {
+		smaHeapRemove(s, SMA_LEAVES, index);
+	}
+}
+
+// once every child of node has been tried its f is the lowest of theirs, which can raise
+// its parent's and so on up
+static void smaBackUp(SmaSearch *s, int index) {
+	while (index >= 0) {
+		SmaNode *node = &s->nodes[index];
+		if ((node->tried & node->legal) != node->legal) {
+			return;
+		}
+		int f = SMA_INFINITY;
+		for (int move = 0; move < 4; move++) {
+			if (node->legal & 1 << move && node->childF[move] < f) {
+				f = node->childF[move];
+			}
+		}
+		if (f <= node->f) {
+			return;
+		}
+		node->f = f;
+		smaRefresh(s, index);
+		const int parent = node->parent;
+		if (parent >= 0) {
+			s->nodes[parent].childF[moveFromChar(node->move)] = f;
+		}
+		index = parent;
+	}
+}
+
+// drops the worst leaf other than keep, returns false if there's nothing to drop
+static bool smaForget(SmaSearch *s, int keep) {
+	const bool keepIsLeaf = s->nodes[keep].at[SMA_LEAVES] >= 0;
+	if (keepIsLeaf) {
+		smaHeapRemove(s, SMA_LEAVES, keep);
+	}
+	const bool found = s->heapCounts[SMA_LEAVES] > 0;
+	if (found) {
+		const int index = s->heaps[SMA_LEAVES][0];
+		SmaNode *leaf = &s->nodes[index];
+		smaHeapRemove(s, SMA_LEAVES, index);
+		smaHeapRemove(s, SMA_OPEN, index);
+		SmaNode *parent = &s->nodes[leaf->parent];
+		const int move = moveFromChar(leaf->move);
+		parent->children[move] = -1;
+		parent->childF[move] = leaf->f;
+		const int parentIndex = leaf->parent;
+		leaf->parent = s->freeList;
+		s->freeList = index;
+		s->live--;
+		smaRefresh(s, parentIndex);
+	}
+	if (keepIsLeaf) {
+		smaHeapSet(s, SMA_LEAVES, keep);
+	}
+	return found;
+}
+
+static int smaAllocate(SmaSearch *s) {
+	int index = s->freeList;
+	if (index >= 0) {
+		s->freeList = s->nodes[index].parent;
+	}
+	else {
+		if (s->count == s->capacity) {
+			s->capacity = 2 * s->capacity < s->maxNodes ? 2 * s->capacity : s->maxNodes;
+			s->nodes = realloc(s->nodes, s->capacity * sizeof(SmaNode));
+			s->cells = realloc(s->cells, s->capacity * (long)s->n);
+			s->heaps[SMA_OPEN] = realloc(s->heaps[SMA_OPEN], s->capacity * sizeof(int));
+			s->heaps[SMA_LEAVES] = realloc(s->heaps[SMA_LEAVES], s->capacity * sizeof(int));
+		}
+		index = s->count++;
+	}
+	s->live++;
+	return index;
+}
+
+// makes node index a board that's just been reached with g moves, its cells already in place
+static void smaInit(SmaSearch *s, const Board *board, const Heuristic *heuristic, int index,
+		int parent, int g, int move) {
+	SmaNode *node = &s->nodes[index];
+	node->parent = parent;
+	node->g = g;
+	node->h = heuristic->estimate(board);
+	node->goal = isGoal(board);
+	node->move = move >= 0 ? moveChars[move] : 0;
+	node->legal = 0;
+	node->tried = 0;
+	for (int m = 0; m < 4; m++) {
+		node->children[m] = -1;
+		if (canMove(board, m) && (move < 0 || m != OPPOSITE_MOVE(move))) {
+			node->legal |= 1 << m;
+		}
+	}
+	node->at[SMA_OPEN] = -1;
+	node->at[SMA_LEAVES] = -1;
+}
+
+// writes an optimal solution in to moves and returns its length, keeping at most
+// memoryBytes worth of boards. returns -1 if it won't fit in capacity, if limit stopped
+// the search, or if the memory can't hold the solution's path
+int solveMemoryBounded(const Board *start, const Heuristic *heuristic, long memoryBytes,
+		const SearchLimit *limit, char *moves, int capacity, SmaStats *stats) {
+	memset(stats, 0, sizeof(SmaStats));
+	const int n = start->rows * start->cols;
+	SmaSearch s = {0};
+	s.n = n;
+	const long maxNodes = memoryBytes / SMA_NODE_BYTES(n);
+	s.maxNodes = maxNodes > INT32_MAX / 2 ? INT32_MAX / 2 : maxNodes;
+	stats->maxNodes = s.maxNodes;
+	if (s.maxNodes < 2) {
+		return -1;
+	}
+	s.freeList = -1;
+	s.capacity = s.maxNodes < 1 << 12 ? s.maxNodes : 1 << 12;
+	s.nodes = malloc(s.capacity * sizeof(SmaNode));
+	s.cells = malloc(s.capacity * (long)n);
+	s.heaps[SMA_OPEN] = malloc(s.capacity * sizeof(int));
+	s.heaps[SMA_LEAVES] = malloc(s.capacity * sizeof(int));
+
+	const int root = smaAllocate(&s);
+	memcpy(s.cells, start->cells, n);
+	smaInit(&s, start, heuristic, root, -1, 0, -1);
+	s.nodes[root].f = s.nodes[root].h;
+	smaRefresh(&s, root);
+
+	Board board = *start;
+	int goal = -1;
+	while (s.heapCounts[SMA_OPEN]) {
+		const int best = s.heaps[SMA_OPEN][0];
+		if (s.nodes[best].goal) {
+			goal = best;
+			break;
+		}
+		if (!(stats->generated & 1023) && limitReached(limit, stats->generated)) {
+			stats->stopped = true;
+			break;
+		}
+
+		// the child that could be best
+		int move = -1;
+		for (int m = 0; m < 4; m++) {
+			if (s.nodes[best].legal & 1 << m && s.nodes[best].children[m] < 0
+					&& (move < 0 || smaBound(&s.nodes[best], m) < smaBound(&s.nodes[best], move))) {
+				move = m;
+			}
+		}
+		const bool again = s.nodes[best].tried & 1 << move;
+		const int bound = smaBound(&s.nodes[best], move);
+		if (s.live == s.maxNodes) {
+			if (!smaForget(&s, best)) {
+				break;
+			}
+			stats->forgotten++;
+		}
+		const int child = smaAllocate(&s);
+		stats->peakNodes = s.live > stats->peakNodes ? s.live : stats->peakNodes;
+		stats->generated++;
+		stats->regenerated += again;
+
+		memcpy(board.cells, &s.cells[best * (long)n], n);
+		for (board.blank = 0; board.cells[board.blank]; board.blank++);
+		applyMove(&board, move);
+		memcpy(&s.cells[child * (long)n], board.cells, n);
+		const int g = s.nodes[best].g + 1;
+		smaInit(&s, &board, heuristic, child, best, g, move);
+		SmaNode *node = &s.nodes[child];
+		if (node->goal) {
+			node->f = g;
+		}
+		else if (g >= s.maxNodes - 1) {
+			// its children wouldn't fit with its path
+			node->f = SMA_INFINITY;
+		}
+		else {
+			node->f = g + node->h > bound ? g + node->h : bound;
+		}
+
+		SmaNode *parent = &s.nodes[best];
+		parent->children[move] = child;
+		parent->childF[move] = node->f;
+		parent->tried |= 1 << move;
+		smaRefresh(&s, child);
+		smaRefresh(&s, best);
+		smaBackUp(&s, best);
+	}
+
+	int length = -1;
+	if (goal >= 0) {
+		length = s.nodes[goal].g;
+		if (length <= capacity) {
+			for (int node = goal, i = length - 1; i >= 0; node = s.nodes[node].parent, i--) {
+				moves[i] = s.nodes[node].move;
+			}
+		}
+		else {
+			length = -1;
+		}
+	}
+	free(s.nodes);
+	free(s.cells);
+	free(s.heaps[SMA_OPEN]);
+	free(s.heaps[SMA_LEAVES]);
+	return length;
+}
@@ -0,0 +1,370 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <time.h>
+#include <getopt.h>
+#include <unistd.h>
+
+#include "board.h"
+#include "records.h"
+#include "ai.h"
+#include "sma.h"
+#include "frontier.h"
+#include "ida.h"
+
+// batch solver: reads instances in either record format, solves each with one engine
+// and writes the solutions as records, with per instance statistics on stderr
+
+#define MAX_SOLUTION MAX_RECORD_MOVES
+
+double weight = 1;
+const Heuristic *heuristic = &heuristics[1];
+double deadlineMs = 1000;
+int threads;
+long memoryMegabytes = 1024;
+bool fsm = true;
+const char *perimeterFile = NULL;
+int perimeterDepth = 16;
+const Perimeter *perimeter = NULL;
+
+// every engine solves a board in to moves, returning the length or -1,
+// and prints whatever statistics it has to log
+typedef struct Engine {
+	int algorithm;
+	int maxCells;
+	int (*solve)(const Board *board, char *moves, int capacity, FILE *log);
+} Engine;
+
+int solveTable(const Board *board, char *moves, int capacity, FILE *log) {
+	if (board->rows != 3 || board->cols != 3) {
+		return -1;
+	}
+	return eightSolve(board, moves);
+}
+
+int solveBidir(const Board *board, char *moves, int capacity, FILE *log) {
+	BidirStats stats;
+	const int length = solveBidirectional(board, NULL, moves, capacity, &stats);
+	fprintf(log, " meet %i+%i expanded %li+%li bound %i iterations %i",
+		stats.depth[0], stats.depth[1], stats.expanded[0], stats.expanded[1], stats.bound, stats.iterations);
+	return length;
+}
+
+int solveAStar(const Board *board, char *moves, int capacity, FILE *log) {
+	AStarStats stats;
+	const int length = solveWeighted(board, heuristic, weight, NULL, moves, capacity, &stats);
+	fprintf(log, " expanded %li generated %li reopened %li optimal >= %i",
+		stats.expanded, stats.generated, stats.reopened, stats.lowerBound);
+	return length;
+}
+
+int solveHda(const Board *board, char *moves, int capacity, FILE *log) {
+	HdaStats stats;
+	const int length = solveParallel(board, heuristic, threads, NULL, moves, capacity, &stats);
+	fprintf(log, " expanded %li generated %li messages %li busiest thread %li",
+		stats.expanded, stats.generated, stats.messages, stats.maxExpanded);
+	return length;
+}
+
+int solveSma(const Board *board, char *moves, int capacity, FILE *log) {
+	SmaStats stats;
+	const int length = solveMemoryBounded(board, heuristic, memoryMegabytes << 20, NULL, moves, capacity, &stats);
+	fprintf(log, " generated %li forgotten %li regenerated %li peak %li of %li boards",
+		stats.generated, stats.forgotten, stats.regenerated, stats.peakNodes, stats.maxNodes);
+	return length;
+}
+
+int solveFrontierSearch(const Board *board, char *moves, int capacity, FILE *log) {
+	FrontierStats stats;
+	const int length = solveFrontier(board, heuristic, NULL, moves, capacity, &stats);
+	fprintf(log, " expanded %li generated %li iterations %i peak %li boards",
+		stats.expanded, stats.generated, stats.iterations, stats.peakNodes);
+	return length;
+}
+
+int solveIdaStar(const Board *board, char *moves, int capacity, FILE *log) {
+	IdaStats stats;
+	const int length = solveIda(board, heuristic, fsm, perimeter, NULL, moves, capacity, &stats);
+	fprintf(log, " expanded %li pruned %li perimeter hits %li iterations %i",
+		stats.expanded, stats.pruned, stats.perimeterHits, stats.iterations);
+	return length;
+}
+
+int solveGreedy(const Board *board, char *moves, int capacity, FILE *log) {
+	return greedySolve(board, moves, capacity);
+}
+
+typedef struct Progress {
+	FILE *log;
+	double start;
+} Progress;
+
+void logImprovement(const char *moves, int length, void *context) {
+	const Progress *progress = context;
+	fprintf(progress->log, " %i@%.1fms", length, monotonicMs() - progress->start);
+}
+
+int solveWithDeadline(const Board *board, char *moves, int capacity, FILE *log) {
+	Progress progress = {log, monotonicMs()};
+	const SearchLimit limit = {progress.start + deadlineMs};
+	AnytimeStats stats;
+	fprintf(log, " improvements");
+	const int length = solveAnytime(board, &greedySolve, &limit, &logImprovement, &progress, moves, capacity, &stats);
+	fprintf(log, " first %i rounds %i%s", stats.initial, stats.rounds, stats.optimal ? " optimal" : "");
+	return length;
+}
+
+Engine engines[] = {
+	{ALGORITHM_GREEDY, MAX_CELLS, &solveGreedy},
+	{ALGORITHM_TABLE, 9, &solveTable},
+	{ALGORITHM_BIDIRECTIONAL, MAX_RANK_CELLS, &solveBidir},
+	{ALGORITHM_WEIGHTED, MAX_CELLS, &solveAStar},
+	{ALGORITHM_ANYTIME, MAX_CELLS, &solveWithDeadline},
+	{ALGORITHM_PARALLEL, HDA_MAX_CELLS, &solveHda},
+	{ALGORITHM_MEMORY_BOUNDED, MAX_CELLS, &solveSma},
+	{ALGORITHM_FRONTIER, MAX_CELLS, &solveFrontierSearch},
+	{ALGORITHM_IDA, MAX_CELLS, &solveIdaStar}
+};
+
+void usage() {
+	fprintf(stderr, "Usage: ./solve [-a algorithm] [-w weight] [-h heuristic] [-t ms] [-j threads] [--mem-limit megabytes]\n"
+			"		[--no-fsm] [--perimeter file [--perimeter-depth depth]] [--pdb-cache dir] [-T trace] [-b]\n"
+			"		input [output]\n"
+			"-a picks the engine:\n"
+			"	greedy: the just for fun greedy algorithm\n"
+			"	table: exact lookup table (3x3 only)\n"
+			"	bidir: bidirectional search (up to %i cells)\n"
+			"	astar: weighted A*, solutions are at most weight times optimal\n"
+			"	anytime: improves on greedy until the deadline\n"
+			"	hda: A* spread over threads by hash, optimal\n"
+			"	sma: A* that forgets its worst boards to stay under --mem-limit, optimal if the path fits\n"
+			"	frontier: breadth first search a layer at a time with no closed list, optimal\n"
+			"	ida: iterative deepening A*, skipping duplicate move sequences, optimal\n"
+			"-h sets the heuristic for astar, hda, sma, frontier and ida: manhattan, conflict (default), pdb, walking\n"
+			"	or packed (pdb in a quarter of the memory)\n"
+			"-w sets the weight for astar, at least 1 (default 1, optimal)\n"
+			"-j sets the number of threads for hda (default 1 per cpu)\n"
+			"--mem-limit sets the megabytes sma may use (default 1024)\n"
+			"--no-fsm makes ida only skip undoing the last move\n"
+			"--perimeter file makes ida stop at boards within --perimeter-depth moves of the goal (default 16)\n"
+			"	kept in file, which is built if it doesn't exist and can be shared by many solves at once\n"
+			"--pdb-cache dir keeps the pdb and packed tables for each board size in dir, so they're only built once\n"
+			"-t sets the deadline per board for anytime in milliseconds (default 1000)\n"
+			"-T writes the trace of the board that couldn't be solved to trace\n"
+			"-b writes binary records instead of text\n"
+			"input may be binary or text records, input and output may be - for stdin/stdout\n",
+			MAX_RANK_CELLS);
+	exit(4);
+}
+
+FILE *openOrStd(const char *path, const char *mode, FILE *std) {
+	if (!strcmp(path, "-")) {
+		return std;
+	}
+	FILE *f = fopen(path, mode);
+	if (f == NULL) {
+		perror(path);
+		exit(5);
+	}
+	return f;
+}
+
+int main(int argc, char *argv[]) {
+	int algorithm = ALGORITHM_BIDIRECTIONAL;
+	bool binary = false;
+	const char *traceFile = NULL;
+
+	const struct option longOptions[] = {
+		{"mem-limit", required_argument, NULL, 'm'},
+		{"no-fsm", no_argument, NULL, 'F'},
+		{"perimeter", required_argument, NULL, 'P'},
+		{"perimeter-depth", required_argument, NULL, 'D'},
+		{"pdb-cache", required_argument, NULL, 'C'},
+		{0}
+	};
+	opterr = 0;
+	int c;
+	threads = sysconf(_SC_NPROCESSORS_ONLN);
+	while ((c = getopt_long(argc, argv, "a:w:h:t:j:T:b", longOptions, NULL)) != -1) {
+		switch (c) {
+			case 'a':
+				algorithm = algorithmFromName(optarg);
+				break;
+			case 'w':
+				weight = atof(optarg);
+				if (weight < 1) {
+					fprintf(stderr, "Weight must be at least 1\n");
+					exit(1);
+				}
+				break;
+			case 'h':
+				heuristic = heuristicFromName(optarg);
+				if (heuristic == NULL) {
+					usage();
+				}
+				break;
+			case 't':
+				deadlineMs = atof(optarg);
+				break;
+			case 'j':
+				threads = atoi(optarg);
+				break;
+			case 'm':
+				memoryMegabytes = atol(optarg);
+				if (memoryMegabytes < 1) {
+					fprintf(stderr, "Memory limit must be at least 1 megabyte\n");
+					exit(1);
+				}
+				break;
+			case 'F':
+				fsm = false;
+				break;
+			case 'P':
+				perimeterFile = optarg;
+				break;
+			case 'D':
+				perimeterDepth = atoi(optarg);
+				if (perimeterDepth < 0 || perimeterDepth > 255) {
+					fprintf(stderr, "Perimeter depth must be from 0 to 255\n");
+					exit(1);
+				}
+				break;
+			case 'C':
+				patternCacheDir = optarg;
+				break;
+			case 'T':
+				traceFile = optarg;
+				break;
+			case 'b':
+				binary = true;
+				break;
+			case ':':
+				fprintf(stderr, "Option %c must take value\n", optopt);
+				exit(1);
+			case '?':
+				fprintf(stderr, "Unknown option %c\n", optopt);
+				exit(2);
+		}
+	}
+	if (argc - optind < 1 || argc - optind > 2) {
+		usage();
+	}
+	const Engine *engine = NULL;
+	for (int i = 0; i < sizeof(engines) / sizeof(*engines); i++) {
+		if (engines[i].algorithm == algorithm) {
+			engine = &engines[i];
+		}
+	}
+	if (engine == NULL) {
+		usage();
+	}
+
+	FILE *in = openOrStd(argv[optind], "rb", stdin);
+	FILE *out = openOrStd(argc - optind == 2 ? argv[optind + 1] : "-", binary ? "wb" : "w", stdout);
+
+	// binary files start with "NPZB", text files with "npuzzle"
+	const int first = getc(in);
+	ungetc(first, in);
+	const bool binaryIn = first == RECORD_MAGIC[0];
+
+	RecordHeader header;
+	if (!(binaryIn ? readRecordHeader(in, &header) : readTextHeader(in, &header))) {
+		fprintf(stderr, "Bad header\n");
+		exit(1);
+	}
+	if (header.rows * header.cols > engine->maxCells) {
+		fprintf(stderr, "%s can't solve %ix%i boards\n", algorithmNames[algorithm], header.rows, header.cols);
+		exit(3);
+	}
+	// any solutions already in the input are read and replaced
+	const RecordHeader inHeader = header;
+	header.algorithm = algorithm;
+	header.flags = RECORD_RLE;
+	if (!binaryIn) {
+		header.encoding = BOARD_PACKED;
+	}
+	if (!(binary ? writeRecordHeader(out, &header) : writeTextHeader(out, &header))) {
+		perror("write");
+		exit(5);
+	}
+
+	// build any tables the heuristic needs up front so they aren't timed as part of the first board
+	if (engine->algorithm == ALGORITHM_WEIGHTED || engine->algorithm == ALGORITHM_PARALLEL
+			|| engine->algorithm == ALGORITHM_MEMORY_BOUNDED || engine->algorithm == ALGORITHM_FRONTIER
+			|| engine->algorithm == ALGORITHM_IDA) {
+		Board goal;
+		goalBoard(&goal, header.rows, header.cols);
+		const double start = monotonicMs();
+		heuristic->estimate(&goal);
+		fprintf(stderr, "%s ready in %.3fms\n", heuristic->name, monotonicMs() - start);
+	}
+
+	static Perimeter opened;
+	if (perimeterFile != NULL && engine->algorithm == ALGORITHM_IDA) {
+		if (header.rows * header.cols > MAX_RANK_CELLS) {
+			fprintf(stderr, "Perimeters can only be made for boards of up to %i cells\n", MAX_RANK_CELLS);
+			exit(3);
+		}
+		const double start = monotonicMs();
+		if (!openPerimeter(&opened, perimeterFile)) {
+			if (!buildPerimeter(perimeterFile, header.rows, header.cols, perimeterDepth)
+					|| !openPerimeter(&opened, perimeterFile)) {
+				perror(perimeterFile);
+				exit(5);
+			}
+		}
+		if (opened.header.rows != header.rows || opened.header.cols != header.cols) {
+			fprintf(stderr, "%s is a perimeter for %ix%i boards\n", perimeterFile, opened.header.rows, opened.header.cols);
+			exit(1);
+		}
+		perimeter = &opened;
+		fprintf(stderr, "perimeter of %lu boards within %i moves ready in %.3fms\n",
+			(unsigned long)opened.header.count, opened.header.depth, monotonicMs() - start);
+	}
+
+	Record record = {0};
+	char moves[MAX_SOLUTION];
+	long count = 0;
+	long totalMoves = 0;
+	double totalMs = 0;
+	int status;
+	while ((status = binaryIn ? readRecord(in, &inHeader, &record) : readTextRecord(in, &inHeader, &record)) == RECORD_OK) {
+		if (!isSolvable(&record.board)) {
+			fprintf(stderr, "Record %li can't be solved\n", count);
+			exit(6);
+		}
+		fprintf(stderr, "%li:", count);
+		clearTrace();
+		const double start = monotonicMs();
+		const int length = engine->solve(&record.board, moves, MAX_SOLUTION, stderr);
+		const double ms = monotonicMs() - start;
+		fprintf(stderr, " moves %i time %.3fms\n", length, ms);
+		if (length < 0) {
+			fprintf(stderr, "Couldn't solve record %li\n", count);
+			if (traceFile != NULL && !dumpTraceFile(traceFile)) {
+				perror(traceFile);
+			}
+			exit(6);
+		}
+		const bool written = binary
+			? writeRecord(out, &header, &record.board, moves, length)
+			: writeTextRecord(out, &header, &record.board, moves, length);
+		if (!written) {
+			perror("write");
+			exit(5);
+		}
+		count++;
+		totalMoves += length;
+		totalMs += ms;
+	}
+	freeRecord(&record);
+	if (status == RECORD_CORRUPT) {
+		fprintf(stderr, "Bad record after %li records\n", count);
+		exit(1);
+	}
+	fprintf(stderr, "solved %li boards, %li moves, %.3fms\n", count, totalMoves, totalMs);
+
+	closePerimeter(&opened);
+	fclose(in);
+	fclose(out);
+}
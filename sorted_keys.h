@@ -0,0 +1,98 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+// sets of packed states kept as sorted arrays of 64 bit keys
+// sorting is a radix sort so building a layer of a breadth first search is linear,
+// and intersections and differences are a single merge
+
+// sorts keys in place, temp must hold as many keys
+void sortKeys(uint64_t *keys, long count, uint64_t *temp) {
+	// 4 passes of 16 bits, skipping passes where every key has the same digit
+	long *counts = malloc((1 << 16) * sizeof(long));
+	for (int shift = 0; shift < 64; shift += 16) {
+		memset(counts, 0, (1 << 16) * sizeof(long));
+		for (long i = 0; i < count; i++) {
+			counts[(keys[i] >> shift) & 0xffff]++;
+		}
+		if (!count || counts[(keys[0] >> shift) & 0xffff] == count) {
+			continue;
+		}
+		long total = 0;
+		for (int digit = 0; digit < (1 << 16); digit++) {
+			const long c = counts[digit];
+			counts[digit] = total;
+			total += c;
+		}
+		for (long i = 0; i < count; i++) {
+			temp[counts[(keys[i] >> shift) & 0xffff]++] = keys[i];
+		}
+		memcpy(keys, temp, count * sizeof(uint64_t));
+	}
+	free(counts);
+}
+
+// removes duplicates from sorted keys, returns the new count
+long uniqueKeys(uint64_t *keys, long count) {
+	if (!count) {
+		return 0;
+	}
+	long kept = 1;
+	for (long i = 1; i < count; i++) {
+		if (keys[i] != keys[kept - 1]) {
+			keys[kept++] = keys[i];
+		}
+	}
+	return kept;
+}
+
+// removes every key also in remove (both sorted), returns the new count
+long subtractKeys(uint64_t *keys, long count, const uint64_t *remove, long removeCount) {
+	long kept = 0;
+	long j = 0;
+	for (long i = 0; i < count; i++) {
+		while (j < removeCount && remove[j] < keys[i]) {
+			j++;
+		}
+		if (j == removeCount || remove[j] != keys[i]) {
+			keys[kept++] = keys[i];
+		}
+	}
+	return kept;
+}
+
+// returns the index in a of the first key both sorted arrays have, or -1
+long firstCommonKey(const uint64_t *a, long aCount, const uint64_t *b, long bCount) {
+	long i = 0;
+	long j = 0;
+	while (i < aCount && j < bCount) {
+		if (a[i] < b[j]) {
+			i++;
+		}
+		else if (a[i] > b[j]) {
+			j++;
+		}
+		else {
+			return i;
+		}
+	}
+	return -1;
+}
+
+bool containsKey(const uint64_t *keys, long count, uint64_t key) {
+	long low = 0;
+	long high = count;
+	while (low < high) {
+		const long middle = low + (high - low) / 2;
+		if (keys[middle] < key) {
+			low = middle + 1;
+		}
+		else {
+			high = middle;
+		}
+	}
+	return low < count && keys[low] == key;
+}
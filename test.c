@@ -0,0 +1,288 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "game_vars.h"
+#include "ai.h"
+#include "board.h"
+#include "random_board.h"
+#include "sma.h"
+#include "frontier.h"
+#include "ida.h"
+#include "verify.h"
+
+// fuzz harness: runs every solver on uniformly random boards for every size in a range,
+// checks every solution with verify.h and, where the optimal length is known from the 3x3
+// table or bidirectional search, that optimal solvers are optimal and bounded ones are in bounds
+// prints a line per size and solver, and exits with 1 if anything failed
+
+#define MAX_SOLUTION (64 * MAX_CELLS)
+#define ORACLE_MAX_CELLS 12 // bidirectional search is quick up to here
+#define MAX_REPORTED 3 // failing boards printed per size and solver
+#define SMA_TEST_BYTES (64 << 10) // small enough that sma has to forget boards
+#define PERIMETER_TEST_DEPTH 8
+
+double deadlineMs = 5;
+
+typedef struct Solver {
+	const char *name;
+	int maxCells;
+	double bound; // at most this times optimal, 0 if there's no bound
+	int (*solve)(const Board *board, char *moves, int capacity);
+} Solver;
+
+typedef struct Tally {
+	long boards;
+	long failures;
+	long moves;
+	double ms;
+} Tally;
+
+int tableSolver(const Board *board, char *moves, int capacity) {
+	return board->rows == 3 && board->cols == 3 ? eightSolve(board, moves) : -1;
+}
+
+int bidirSolver(const Board *board, char *moves, int capacity) {
+	BidirStats stats;
+	return solveBidirectional(board, NULL, moves, capacity, &stats);
+}
+
+int aStarSolver(const Board *board, char *moves, int capacity) {
+	AStarStats stats;
+	return solveWeighted(board, &heuristics[1], 1, NULL, moves, capacity, &stats);
+}
+
+int walkingSolver(const Board *board, char *moves, int capacity) {
+	AStarStats stats;
+	return solveWeighted(board, heuristicFromName("walking"), 1, NULL, moves, capacity, &stats);
+}
+
+int packedSolver(const Board *board, char *moves, int capacity) {
+	AStarStats stats;
+	return solveWeighted(board, heuristicFromName("packed"), 1, NULL, moves, capacity, &stats);
+}
+
+int hdaSolver(const Board *board, char *moves, int capacity) {
+	HdaStats stats;
+	return solveParallel(board, &heuristics[1], 4, NULL, moves, capacity, &stats);
+}
+
+int smaSolver(const Board *board, char *moves, int capacity) {
+	SmaStats stats;
+	return solveMemoryBounded(board, &heuristics[1], SMA_TEST_BYTES, NULL, moves, capacity, &stats);
+}
+
+int frontierSolver(const Board *board, char *moves, int capacity) {
+	FrontierStats stats;
+	return solveFrontier(board, &heuristics[1], NULL, moves, capacity, &stats);
+}
+
+int idaSolver(const Board *board, char *moves, int capacity) {
+	IdaStats stats;
+	return solveIda(board, &heuristics[1], true, NULL, NULL, moves, capacity, &stats);
+}
+
+// ida with a perimeter built for each size, in a file that's gone as soon as it's mapped
+int perimeterSolver(const Board *board, char *moves, int capacity) {
+	static Perimeter perimeter;
+	if (perimeter.header.rows != board->rows || perimeter.header.cols != board->cols) {
+		closePerimeter(&perimeter);
+		char path[64];
+		snprintf(path, sizeof(path), "/tmp/npuzzle-perimeter.%i", getpid());
+		const bool opened = buildPerimeter(path, board->rows, board->cols, PERIMETER_TEST_DEPTH)
+			&& openPerimeter(&perimeter, path);
+		unlink(path);
+		if (!opened) {
+			return -1;
+		}
+	}
+	IdaStats stats;
+	return solveIda(board, &heuristics[1], true, &perimeter, NULL, moves, capacity, &stats);
+}
+
+int weightedSolver(const Board *board, char *moves, int capacity) {
+	AStarStats stats;
+	return solveWeighted(board, &heuristics[2], 2, NULL, moves, capacity, &stats);
+}
+
+void ignoreImprovement(const char *moves, int length, void *context) {}
+
+int anytimeSolver(const Board *board, char *moves, int capacity) {
+	const SearchLimit limit = {monotonicMs() + deadlineMs};
+	AnytimeStats stats;
+	return solveAnytime(board, &greedySolve, &limit, &ignoreImprovement, NULL, moves, capacity, &stats);
+}
+
+const Solver solvers[] = {
+	{"greedy", MAX_CELLS, 0, &greedySolve},
+	{"table", 9, 1, &tableSolver},
+	{"bidir", ORACLE_MAX_CELLS, 1, &bidirSolver},
+	{"astar", ORACLE_MAX_CELLS, 1, &aStarSolver},
+	{"walking", ORACLE_MAX_CELLS, 1, &walkingSolver},
+	{"packed", ORACLE_MAX_CELLS, 1, &packedSolver},
+	{"hda", ORACLE_MAX_CELLS, 1, &hdaSolver},
+	{"sma", ORACLE_MAX_CELLS, 1, &smaSolver},
+	{"frontier", ORACLE_MAX_CELLS, 1, &frontierSolver},
+	{"ida", ORACLE_MAX_CELLS, 1, &idaSolver},
+	{"perimeter", ORACLE_MAX_CELLS, 1, &perimeterSolver},
+	{"astar2", 16, 2, &weightedSolver},
+	{"anytime", MAX_CELLS, 0, &anytimeSolver}
+};
+#define SOLVER_COUNT (sizeof(solvers) / sizeof(*solvers))
+
+void usage() {
+	fprintf(stderr, "Usage: ./test [-n boards] [-s seed] [-m min] [-M max] [-a solver] [-t ms]\n"
+			"-n sets the boards per size (default 20)\n"
+			"-m and -M set the smallest and largest rows and columns (default 2 and 10)\n"
+			"-a only runs one solver: greedy, table, bidir, astar, walking, packed, hda,\n"
+			"	sma, frontier, ida, perimeter, astar2 or anytime\n"
+			"-t sets the deadline per board for anytime in milliseconds (default 5)\n");
+	exit(4);
+}
+
+void printBoard(FILE *f, const Board *board) {
+	for (int i = 0; i < board->rows * board->cols; i++) {
+		fprintf(f, "%s%i", i ? " " : "", board->cells[i]);
+	}
+	fputc('\n', f);
+}
+
+// returns whether the solution is good, printing why if it isn't and reported is low enough
+bool checkSolution(const Solver *solver, const Board *board, const char *moves, int length,
+		int optimal, long reported) {
+	const char *problem = NULL;
+	int at = 0;
+	int result = VERIFY_OK;
+	if (length < 0) {
+		problem = "no solution";
+	}
+	else if ((result = verifySolution(board, moves, length, &at)) != VERIFY_OK) {
+		problem = verifyResultNames[result];
+	}
+	else if (optimal >= 0 && length < optimal) {
+		problem = "shorter than optimal";
+	}
+	else if (optimal >= 0 && solver->bound && length > solver->bound * optimal + 1e-9) {
+		problem = "too long";
+	}
+	if (problem != NULL && reported < MAX_REPORTED) {
+		fprintf(stderr, "%ix%i %s: %s (length %i, optimal %i, at move %i) on ",
+				board->rows, board->cols, solver->name, problem, length, optimal, at);
+		printBoard(stderr, board);
+	}
+	return problem == NULL;
+}
+
+int main(int argc, char *argv[]) {
+	long boards = 20;
+	long seed = time(0);
+	int minSize = 2;
+	int maxSize = 10;
+	const char *only = NULL;
+
+	opterr = 0;
+	int c;
+	while ((c = getopt(argc, argv, "n:s:m:M:a:t:")) != -1) {
+		switch (c) {
+			case 'n':
+				boards = atol(optarg);
+				break;
+			case 's':
+				seed = atol(optarg);
+				break;
+			case 'm':
+				minSize = atoi(optarg);
+				break;
+			case 'M':
+				maxSize = atoi(optarg);
+				break;
+			case 'a':
+				only = optarg;
+				break;
+			case 't':
+				deadlineMs = atof(optarg);
+				break;
+			case ':':
+				fprintf(stderr, "Option %c must take value\n", optopt);
+				exit(1);
+			case '?':
+				fprintf(stderr, "Unknown option %c\n", optopt);
+				exit(2);
+		}
+	}
+	if (optind != argc || minSize < 2 || maxSize < minSize || maxSize * maxSize > MAX_CELLS) {
+		usage();
+	}
+	printf("seed %li\n", seed);
+	uint64_t random = (uint64_t)seed * 0x9e3779b97f4a7c15 + 1;
+
+	char *moves = malloc(MAX_SOLUTION);
+	char *oracleMoves = malloc(MAX_SOLUTION);
+	long failures = 0;
+	for (int rows = minSize; rows <= maxSize; rows++) {
+		for (int cols = minSize; cols <= maxSize; cols++) {
+			Tally tallies[SOLVER_COUNT] = {0};
+			for (long i = 0; i < boards; i++) {
+				Board board;
+				randomSolvableBoard(&random, rows, cols, &board);
+				// the boards are all solvable, and swapping 2 tiles flips that
+				Board swapped = board;
+				const int first = (board.blank + 1) % (rows * cols);
+				const int second = (board.blank + 2) % (rows * cols);
+				swapped.cells[first] = board.cells[second];
+				swapped.cells[second] = board.cells[first];
+				if (!isSolvable(&board) || isSolvable(&swapped)) {
+					fprintf(stderr, "%ix%i isSolvable wrong on ", rows, cols);
+					printBoard(stderr, &board);
+					failures++;
+				}
+				int optimal = -1;
+				if (rows == 3 && cols == 3) {
+					optimal = tableSolver(&board, oracleMoves, MAX_SOLUTION);
+				}
+				else if (rows * cols <= ORACLE_MAX_CELLS) {
+					optimal = bidirSolver(&board, oracleMoves, MAX_SOLUTION);
+				}
+
+				for (int s = 0; s < SOLVER_COUNT; s++) {
+					const Solver *solver = &solvers[s];
+					if (rows * cols > solver->maxCells || (only != NULL && strcmp(only, solver->name))
+							|| (solver->solve == &tableSolver && (rows != 3 || cols != 3))) {
+						continue;
+					}
+					Tally *tally = &tallies[s];
+					const double start = monotonicMs();
+					const int length = solver->solve(&board, moves, MAX_SOLUTION);
+					tally->ms += monotonicMs() - start;
+					tally->boards++;
+					if (checkSolution(solver, &board, moves, length, optimal, tally->failures)) {
+						tally->moves += length;
+					}
+					else {
+						tally->failures++;
+					}
+				}
+			}
+			for (int s = 0; s < SOLVER_COUNT; s++) {
+				const Tally *tally = &tallies[s];
+				if (!tally->boards) {
+					continue;
+				}
+				const long solved = tally->boards - tally->failures;
+				printf("%ix%i %-8s boards %li failures %li average moves %.1f average time %.3fms\n",
+						rows, cols, solvers[s].name, tally->boards, tally->failures,
+						solved ? (double)tally->moves / solved : 0, tally->ms / tally->boards);
+				failures += tally->failures;
+			}
+			fflush(stdout);
+		}
+	}
+	free(moves);
+	free(oracleMoves);
+	printf("%li failures\n", failures);
+	return failures != 0;
+}
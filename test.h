@@ -20,13 +20,6 @@ void floatGetch(float f) {
 	quitGetch();
 }
 
-#define interactiveDebug(...) \
-do { \
-	mvhline(0, 0, ' ', 69); \
-	mvprintw(0, 0, __VA_ARGS__); \
-	quitGetch(); \
-} while (false);
-
 void printArr(int y, int x, int myArr[], int length) {
     mvhline(y, x, ' ', 225);
     int spaces = 0;
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+// an in memory trace of what the solvers were doing, for looking at after the fact
+//
+// recording an event is a timestamp and a few word writes in to a ring buffer that keeps
+// the last TRACE_SIZE events. the format isn't applied until the trace is dumped, so the
+// format has to be a string literal and it can take up to 4 ints
+// slots are claimed with an atomic add so threads can trace at once without locking,
+// but an event being overwritten while it's dumped can come out mixed up
+//
+// events below TRACE_MIN_LEVEL compile to nothing
+
+#define TRACE_SIZE 4096 // power of 2
+#define TRACE_FILE "trace.log" // where the game writes the trace when t is pressed
+
+#ifndef TRACE_MIN_LEVEL
+#define TRACE_MIN_LEVEL TRACE_DEBUG
+#endif
+
+enum TRACE_LEVEL {
+	TRACE_DEBUG, // which branch the ai took and why
+	TRACE_INFO, // where the ai is up to
+	TRACE_WARN // things that shouldn't happen
+};
+
+const char *traceLevelNames[] = {"debug", "info", "warn"};
+
+typedef struct TraceEvent {
+	int64_t ns;
+	const char *format;
+	int level;
+	int args[4];
+} TraceEvent;
+
+typedef struct TraceRing {
+	TraceEvent events[TRACE_SIZE];
+	uint64_t next; // total events ever recorded
+} TraceRing;
+
+TraceRing traceRing;
+
+static inline void traceEvent(int level, const char *format, int a, int b, int c, int d) {
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	const uint64_t i = __atomic_fetch_add(&traceRing.next, 1, __ATOMIC_RELAXED) & (TRACE_SIZE - 1);
+	TraceEvent *event = &traceRing.events[i];
+	event->ns = t.tv_sec * (int64_t)1000000000 + t.tv_nsec;
+	event->format = format;
+	event->level = level;
+	event->args[0] = a;
+	event->args[1] = b;
+	event->args[2] = c;
+	event->args[3] = d;
+}
+
+// pads the arguments out to 4 with 0s
+#define TRACE_PADDED(level, format, a, b, c, d, ...) traceEvent((level), (format), (a), (b), (c), (d))
+#define TRACE(level, ...) \
+do { \
+	if ((level) >= TRACE_MIN_LEVEL) { \
+		TRACE_PADDED((level), __VA_ARGS__, 0, 0, 0, 0); \
+	} \
+} while (false)
+
+// writes the events still in the buffer, oldest first, with times relative to the first
+void dumpTrace(FILE *f) {
+	const uint64_t end = __atomic_load_n(&traceRing.next, __ATOMIC_RELAXED);
+	const uint64_t start = end > TRACE_SIZE ? end - TRACE_SIZE : 0;
+	if (start) {
+		fprintf(f, "(%llu earlier events dropped)\n", (unsigned long long)start);
+	}
+	const int64_t first = traceRing.events[start & (TRACE_SIZE - 1)].ns;
+	for (uint64_t i = start; i < end; i++) {
+		const TraceEvent *event = &traceRing.events[i & (TRACE_SIZE - 1)];
+		fprintf(f, "%12.3fus %-5s ", (event->ns - first) / 1e3, traceLevelNames[event->level]);
+		fprintf(f, event->format, event->args[0], event->args[1], event->args[2], event->args[3]);
+		fputc('\n', f);
+	}
+}
+
+// returns whether it could write to path
+bool dumpTraceFile(const char *path) {
+	FILE *f = fopen(path, "w");
+	if (f == NULL) {
+		return false;
+	}
+	dumpTrace(f);
+	fclose(f);
+	return true;
+}
+
+void clearTrace() {
+	traceRing.next = 0;
+}
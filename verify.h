@@ -0,0 +1,73 @@
+#pragma once
+
+#include <stdbool.h>
+
+#include "board.h"
+
+// checks a solution by playing it on a copy of the board
+
+enum VERIFY_RESULT {
+	VERIFY_OK,
+	VERIFY_BAD_CHAR, // not one of urdl
+	VERIFY_OFF_BOARD, // would move the 0 off the board
+	VERIFY_NOT_SOLVED // every move was legal but the board doesn't end up solved
+};
+
+const char *verifyResultNames[] = {"ok", "bad move character", "move off the board", "not solved"};
+
+// returns one of VERIFY_RESULT
+// if at isn't NULL it gets the index of the move that was wrong, or length if it's not solved
+int verifySolution(const Board *start, const char *moves, int length, int *at) {
+	const int rows = start->rows;
+	const int cols = start->cols;
+	const int n = rows * cols;
+	unsigned char cells[MAX_CELLS];
+	for (int i = 0; i < n; i++) {
+		cells[i] = start->cells[i];
+	}
+	int y = start->blank / cols;
+	int x = start->blank % cols;
+	int blank = start->blank;
+
+	for (int i = 0; i < length; i++) {
+		int to;
+		switch (moves[i]) {
+			case 'u':
+				to = y ? blank - cols : -1;
+				y--;
+				break;
+			case 'd':
+				to = y < rows - 1 ? blank + cols : -1;
+				y++;
+				break;
+			case 'l':
+				to = x ? blank - 1 : -1;
+				x--;
+				break;
+			case 'r':
+				to = x < cols - 1 ? blank + 1 : -1;
+				x++;
+				break;
+			default:
+				to = -2;
+		}
+		if (to < 0) {
+			if (at != NULL) {
+				*at = i;
+			}
+			return to == -1 ? VERIFY_OFF_BOARD : VERIFY_BAD_CHAR;
+		}
+		cells[blank] = cells[to];
+		blank = to;
+	}
+	cells[blank] = 0;
+	if (at != NULL) {
+		*at = length;
+	}
+	for (int i = 0; i < n; i++) {
+		if (cells[i] != i) {
+			return VERIFY_NOT_SOLVED;
+		}
+	}
+	return VERIFY_OK;
+}
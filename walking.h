@@ -0,0 +1,274 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "board.h"
+#include "heuristic.h"
+
+// Takahashi's walking distance
+// http://www.ic-net.or.jp/home/takaken/e/15pz/wd.gif
+//
+// looking only at rows, a board is how many tiles in each row belong in each row, and where
+// the 0 is. every vertical move takes a tile out of the 0's neighbouring row and puts it in the
+// 0's row, horizontal moves don't change anything. a breadth first search over just those
+// configurations finds the fewest vertical moves any board with that configuration needs.
+// the same for columns gives the fewest horizontal moves, and the sum never overestimates.
+// unlike manhattan it sees tiles in the same row getting in each others' way
+//
+// a configuration is packed as a count per (line, class) in 4 bits plus the 0's line. the
+// searches store every configuration with links to the ones a move leads to, so a board can
+// be followed move by move without repacking it. past WALKING_MAX_STATES configurations
+// (a 5 next to a side of 4 or more) the table isn't built and linear conflict is used instead
+
+#define WALKING_MAX_SIDE 5 // so a configuration fits in 128 bits
+#define WALKING_MAX_STATES (1 << 21)
+#define WALKING_NONE -1
+
+typedef unsigned __int128 WalkingKey;
+
+// one direction: lines are rows and classes goal rows, or lines are columns and classes goal columns
+typedef struct WalkingTable {
+	int lines;
+	int length; // cells in a line
+	int count;
+	int capacity;
+	WalkingKey *keys;
+	unsigned char *distances;
+	int32_t *links; // [state][toward line 0 or away][class of the tile moved], WALKING_NONE if impossible
+	int32_t *slots; // open addressed, state + 1, 0 is empty
+	uint64_t slotMask;
+} WalkingTable;
+
+typedef struct WalkingTables {
+	int rows;
+	int cols;
+	bool built; // false if either table has too many states
+	WalkingTable vertical;
+	WalkingTable horizontal;
+} WalkingTables;
+
+// where a board is in both tables
+typedef struct WalkingState {
+	int vertical;
+	int horizontal;
+} WalkingState;
+
+static inline WalkingKey walkingBit(int lines, int line, int class) {
+	return (WalkingKey)1 << (4 * (line * lines + class));
+}
+
+static inline int walkingCount(WalkingKey key, int lines, int line, int class) {
+	return (int)(key >> (4 * (line * lines + class))) & 0xf;
+}
+
+static inline int walkingBlank(WalkingKey key, int lines) {
+	return (int)(key >> (4 * lines * lines)) & 0xf;
+}
+
+static inline uint64_t walkingHash(WalkingKey key) {
+	const uint64_t mixed = (uint64_t)key ^ (uint64_t)(key >> 64) * 0xbf58476d1ce4e5b9;
+	return (mixed * 0x9e3779b97f4a7c15) >> 17;
+}
+
+// returns the state of key, or WALKING_NONE
+int findWalkingState(const WalkingTable *table, WalkingKey key) {
+	for (uint64_t i = walkingHash(key) & table->slotMask; table->slots[i]; i = (i + 1) & table->slotMask) {
+		if (table->keys[table->slots[i] - 1] == key) {
+			return table->slots[i] - 1;
+		}
+	}
+	return WALKING_NONE;
+}
+
+static void growWalkingTable(WalkingTable *table) {
+	table->capacity *= 2;
+	table->keys = realloc(table->keys, table->capacity * sizeof(WalkingKey));
+	table->distances = realloc(table->distances, table->capacity);
+	table->links = realloc(table->links, (long)table->capacity * 2 * table->lines * sizeof(int32_t));
+	free(table->slots);
+	table->slotMask = 2 * table->capacity - 1;
+	table->slots = calloc(table->slotMask + 1, sizeof(int32_t));
+	for (int state = 0; state < table->count; state++) {
+		uint64_t i = walkingHash(table->keys[state]) & table->slotMask;
+		while (table->slots[i]) {
+			i = (i + 1) & table->slotMask;
+		}
+		table->slots[i] = state + 1;
+	}
+}
+
+// adds key if it's new and returns its state, or WALKING_NONE if the table is full
+static int addWalkingState(WalkingTable *table, WalkingKey key, int distance) {
+	const int found = findWalkingState(table, key);
+	if (found != WALKING_NONE) {
+		return found;
+	}
+	if (table->count == WALKING_MAX_STATES) {
+		return WALKING_NONE;
+	}
+	if (table->count == table->capacity) {
+		growWalkingTable(table);
+	}
+	uint64_t i = walkingHash(key) & table->slotMask;
+	while (table->slots[i]) {
+		i = (i + 1) & table->slotMask;
+	}
+	const int state = table->count++;
+	table->keys[state] = key;
+	table->distances[state] = distance;
+	table->slots[i] = state + 1;
+	return state;
+}
+
+void freeWalkingTable(WalkingTable *table) {
+	free(table->keys);
+	free(table->distances);
+	free(table->links);
+	free(table->slots);
+	memset(table, 0, sizeof(WalkingTable));
+}
+
+// breadth first search from the goal, where the 0 is in line 0 and every other tile is home
+// returns false if there were too many configurations
+bool buildWalkingTable(WalkingTable *table, int lines, int length) {
+	memset(table, 0, sizeof(WalkingTable));
+	table->lines = lines;
+	table->length = length;
+	table->capacity = 1 << 9;
+	growWalkingTable(table);
+
+	WalkingKey goal = 0; // the 0 is in line 0
+	for (int line = 0; line < lines; line++) {
+		goal += walkingBit(lines, line, line) * (line ? length : length - 1);
+	}
+	addWalkingState(table, goal, 0);
+
+	// the states are numbered in the order they're found, so they're their own queue
+	const int blankShift = 4 * lines * lines;
+	for (int state = 0; state < table->count; state++) {
+		const WalkingKey key = table->keys[state];
+		const int blank = walkingBlank(key, lines);
+		for (int away = 0; away < 2; away++) {
+			const int from = away ? blank + 1 : blank - 1;
+			for (int class = 0; class < lines; class++) {
+				int next = WALKING_NONE;
+				if (from >= 0 && from < lines && walkingCount(key, lines, from, class)) {
+					// the tile moves from the 0's new line in to its old one
+					WalkingKey moved = key - walkingBit(lines, from, class) + walkingBit(lines, blank, class);
+					moved = moved - ((WalkingKey)blank << blankShift) + ((WalkingKey)from << blankShift);
+					next = addWalkingState(table, moved, table->distances[state] + 1);
+					if (next == WALKING_NONE) {
+						freeWalkingTable(table);
+						return false;
+					}
+				}
+				// adding may have moved the links
+				table->links[((long)state * 2 + away) * lines + class] = next;
+			}
+		}
+	}
+	return true;
+}
+
+// the tables for the last board size asked for, built the first time they're needed
+// building them isn't thread safe, so a multithreaded search has to ask for its size once first
+WalkingTables *walkingTables(int rows, int cols) {
+	static WalkingTables *tables = NULL;
+	if (tables == NULL) {
+		tables = calloc(1, sizeof(WalkingTables));
+	}
+	if (tables->rows != rows || tables->cols != cols) {
+		// on a square board columns are rows of the reflected board, so both use one table
+		if (tables->rows != tables->cols) {
+			freeWalkingTable(&tables->horizontal);
+		}
+		freeWalkingTable(&tables->vertical);
+		memset(&tables->horizontal, 0, sizeof(WalkingTable));
+		tables->rows = rows;
+		tables->cols = cols;
+		tables->built = rows <= WALKING_MAX_SIDE && cols <= WALKING_MAX_SIDE
+			&& buildWalkingTable(&tables->vertical, rows, cols)
+			&& (rows == cols || buildWalkingTable(&tables->horizontal, cols, rows));
+		if (!tables->built) {
+			freeWalkingTable(&tables->vertical);
+		}
+		else if (rows == cols) {
+			tables->horizontal = tables->vertical;
+		}
+	}
+	return tables;
+}
+
+// finds where board is in both tables, assumes they're built
+WalkingState walkingStart(const WalkingTables *tables, const Board *board) {
+	const int rows = board->rows;
+	const int cols = board->cols;
+	WalkingKey vertical = (WalkingKey)(board->blank / cols) << (4 * rows * rows);
+	WalkingKey horizontal = (WalkingKey)(board->blank % cols) << (4 * cols * cols);
+	for (int i = 0; i < rows * cols; i++) {
+		const int v = board->cells[i];
+		if (v) {
+			vertical += walkingBit(rows, i / cols, v / cols);
+			horizontal += walkingBit(cols, i % cols, v % cols);
+		}
+	}
+	return (WalkingState){findWalkingState(&tables->vertical, vertical), findWalkingState(&tables->horizontal, horizontal)};
+}
+
+// follows the 0 making move, before it's applied to board
+static inline WalkingState walkingMove(const WalkingTables *tables, WalkingState state, const Board *board, int move) {
+	const int tile = board->cells[board->blank + moveOffset(board, move)];
+	const int cols = board->cols;
+	switch (move) {
+		case MOVE_UP:
+		case MOVE_DOWN:
+			state.vertical = tables->vertical.links[((long)state.vertical * 2 + (move == MOVE_DOWN)) * board->rows + tile / cols];
+			break;
+		default:
+			state.horizontal = tables->horizontal.links[((long)state.horizontal * 2 + (move == MOVE_RIGHT)) * cols + tile % cols];
+	}
+	return state;
+}
+
+static inline int walkingValue(const WalkingTables *tables, WalkingState state) {
+	return tables->vertical.distances[state.vertical] + tables->horizontal.distances[state.horizontal];
+}
+
+// a WalkingState as a HeuristicState, so the searches can follow boards move by move
+static inline HeuristicState packWalking(WalkingState state) {
+	return (uint32_t)state.vertical | (uint64_t)(uint32_t)state.horizontal << 32;
+}
+
+static inline WalkingState unpackWalking(HeuristicState state) {
+	return (WalkingState){(int32_t)(uint32_t)state, (int32_t)(state >> 32)};
+}
+
+HeuristicState walkingStartState(const Board *board) {
+	const WalkingTables *tables = walkingTables(board->rows, board->cols);
+	return tables->built ? packWalking(walkingStart(tables, board)) : 0;
+}
+
+HeuristicState walkingMoveState(HeuristicState state, const Board *board, int move) {
+	const WalkingTables *tables = walkingTables(board->rows, board->cols);
+	return tables->built ? packWalking(walkingMove(tables, unpackWalking(state), board, move)) : 0;
+}
+
+// the larger of walking distance and linear conflict, they each catch tiles getting in each
+// others' way that the other doesn't and together expand about half the boards A* does
+// with linear conflict alone on 4x4
+int walkingStateValue(HeuristicState state, const Board *board) {
+	const WalkingTables *tables = walkingTables(board->rows, board->cols);
+	const int conflict = linearConflict(board);
+	if (!tables->built) {
+		return conflict;
+	}
+	const int walking = walkingValue(tables, unpackWalking(state));
+	return walking > conflict ? walking : conflict;
+}
+
+int walkingDistance(const Board *board) {
+	return walkingStateValue(walkingStartState(board), board);
+}